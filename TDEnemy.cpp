@@ -1,6 +1,8 @@
 // TDEnemy.cpp
 #include "TDEnemy.hpp"
 #include "EnemyStats.hpp"    // for get_enemy_stats
+#include "frame_snapshot.hpp"
+#include "state_hash.hpp"
 
 #include <algorithm>         // std::max
 
@@ -19,16 +21,21 @@ TDEnemy::TDEnemy(EnemyType type, const sf::Vector2f& startPos)
     _shape.setOrigin(stats.radius, stats.radius);
     _shape.setFillColor(_baseColor);
     _shape.setPosition(startPos);
+    _prevPos = startPos;
 }
 
 bool TDEnemy::update(float dt,
     const std::vector<sf::Vector2f>& path,
-    float tileSize)
+    float tileSize,
+    bool flash)
 {
     if (path.size() < 2) {
         return false; // nowhere to go
     }
 
+    // Remember where we started this step (for render interpolation)
+    _prevPos = _shape.getPosition();
+
     // Move along the path in "tile segments"
     float deltaT = (_speed * dt) / tileSize;
     _t += deltaT;
@@ -46,8 +53,9 @@ bool TDEnemy::update(float dt,
         _shape.setPosition(a + (b - a) * local);
     }
 
-    // Hit flash colour
-    if (_flashTimer > 0.f) {
+    // Hit flash colour. Setting a colour rewrites every vertex of the
+    // shape, so only do it when the colour actually changes.
+    if (_flashTimer > 0.f && flash) {
         _flashTimer -= dt;
         float t = std::max(_flashTimer / 0.2f, 0.f);
 
@@ -59,13 +67,28 @@ bool TDEnemy::update(float dt,
         _shape.setFillColor(c);
     }
     else {
-        _shape.setFillColor(_baseColor);
+        if (_flashTimer > 0.f) _flashTimer -= dt;
+        if (_shape.getFillColor() != _baseColor) _shape.setFillColor(_baseColor);
     }
 
     // Let the scene decide what to do if its at the end
     return (segment >= static_cast<int>(path.size()) - 1);
 }
 
+void TDEnemy::publish(FrameSnapshot& out) const
+{
+    out.add_circle(_prevPos, _shape.getPosition(), _shape.getRadius(), _shape.getFillColor());
+}
+
+void TDEnemy::hash_state(StateHash& h) const
+{
+    h.add(static_cast<int>(_type));
+    h.add(_t);
+    h.add(_shape.getPosition());
+    h.add(_hp);
+    h.add(_flashTimer);
+}
+
 void TDEnemy::applyDamage(int amount)
 {
     if (_hp <= 0) return;
@@ -5,16 +5,24 @@
 #include <vector>
 #include "EnemyType.hpp"
 
+struct FrameSnapshot;
+class StateHash;
+
 class TDEnemy {
 public:
     TDEnemy(EnemyType type, const sf::Vector2f& startPos);
 
-    // Move along the shared path and update flash colour.
+    // Move along the shared path and update flash colour (skipped when
+    // `flash` is false; the flash timer still runs).
     // Returns true if this enemy reached the end of the path this frame.
-    bool update(float dt, const std::vector<sf::Vector2f>& path, float tileSize);
+    bool update(float dt, const std::vector<sf::Vector2f>& path, float tileSize,
+        bool flash = true);
+
+    // Add to the frame snapshot (interpolated from the last step's start)
+    void publish(FrameSnapshot& out) const;
 
-    // Basic render helper (optional  you can also just use getShape())
-    void render(sf::RenderWindow& window) const { window.draw(_shape); }
+    // Feed path progress, position and health into a state checksum
+    void hash_state(StateHash& h) const;
 
     // Combat helpers
     void applyDamage(int amount);
@@ -35,6 +43,7 @@ private:
     EnemyType      _type;
     float          _t = 0.f;          // parametric position along path
     sf::CircleShape _shape;
+    sf::Vector2f   _prevPos;          // position at start of last update
 
     int            _hp = 1;
     int            _maxHp = 1;
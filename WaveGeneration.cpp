@@ -1,6 +1,9 @@
 // WaveGeneration.cpp
 #include "WaveGeneration.hpp"
 #include "EnemyStats.hpp"
+#include "trace.hpp"
+#include "alloc_tracker.hpp"
+#include "state_hash.hpp"
 
 #include <random>
 #include <algorithm>
@@ -22,8 +25,8 @@ static EnemyType boss_for_level(int levelIndex) {
 }
 
 // Decide which enemy types are unlocked on a given level
-static std::vector<EnemyType> allowed_for_level(int levelIndex) {
-    std::vector<EnemyType> types;
+static void allowed_for_level(int levelIndex, std::vector<EnemyType>& types) {
+    types.clear();
 
     // Level 1
     types.push_back(EnemyType::Basic);
@@ -49,13 +52,11 @@ static std::vector<EnemyType> allowed_for_level(int levelIndex) {
         types.push_back(EnemyType::LongRange);
         types.push_back(EnemyType::HeavyTank);
     }
-
-    return types;
 }
 
-// Build a point budget + spawn interval for this level/wave
-static WaveConfig make_wave_config(int levelIndex, int waveIndex) {
-    WaveConfig cfg{};
+// Build a point budget + spawn interval for this level/wave into `cfg`
+// (filled in place, so its allowedTypes capacity is reused)
+static void make_wave_config(int levelIndex, int waveIndex, WaveConfig& cfg) {
     cfg.levelIndex = levelIndex;
     cfg.waveIndex = waveIndex;
 
@@ -71,15 +72,11 @@ static WaveConfig make_wave_config(int levelIndex, int waveIndex) {
     float speedUp = 0.05f * (levelIndex + waveIndex); // small reduction
     cfg.spawnInterval = clampf(baseInterval - speedUp, 0.25f, 1.0f);
 
-    cfg.allowedTypes = allowed_for_level(levelIndex);
+    allowed_for_level(levelIndex, cfg.allowedTypes);
 
     // Boss only on the last wave of the level
     cfg.hasBoss = (waveIndex == WaveManager::kWavesPerLevel - 1);
-    if (cfg.hasBoss) {
-        cfg.bossType = boss_for_level(levelIndex);
-    }
-
-    return cfg;
+    cfg.bossType = cfg.hasBoss ? boss_for_level(levelIndex) : EnemyType::Boss1;
 }
 
 // --------------------------
@@ -88,8 +85,11 @@ static WaveConfig make_wave_config(int levelIndex, int waveIndex) {
 
 WaveManager::WaveManager() {
     // Simple deterministic seed so behaviour is repeatable between runs.
-    // We can swap this to std::random_device later for true randomness.
-    _rngSeed = 123456u;
+    // A run can pick its own with setSeed() (GameSession::set_seed).
+    _rngSeed = kDefaultSeed;
+
+    // Every non-boss type, so wave setup never grows it
+    _currentConfig.allowedTypes.reserve(kMaxAllowedTypes);
     reset();
 }
 
@@ -111,27 +111,26 @@ void WaveManager::setupCurrentWave() {
         return;
     }
 
-    _currentConfig = make_wave_config(_currentLevel, _currentWave);
+    make_wave_config(_currentLevel, _currentWave, _currentConfig);
     _remainingPoints = _currentConfig.pointBudget;
     _timeSinceSpawn = 0.f;
     _bossSpawnedThisWave = false;
 }
 
-EnemyType WaveManager::chooseRandomEnemyType() {
-    // Filter to enemies we can afford with remaining points
-    std::vector<EnemyType> candidates;
-    candidates.reserve(_currentConfig.allowedTypes.size());
+// Enemies we can afford with the remaining points (in allowedTypes order)
+bool WaveManager::canAfford(EnemyType type) const {
+    return std::max(get_enemy_stats(type).cost, 1) <= _remainingPoints;
+}
 
+EnemyType WaveManager::chooseRandomEnemyType() {
+    // Count the candidates first instead of collecting them
+    unsigned int candidates = 0;
     for (auto t : _currentConfig.allowedTypes) {
-        EnemyStats st = get_enemy_stats(t);
-        int cost = std::max(st.cost, 1);
-        if (cost <= _remainingPoints) {
-            candidates.push_back(t);
-        }
+        if (canAfford(t)) ++candidates;
     }
 
     // If nothing fits in the remaining budget, end the wave
-    if (candidates.empty()) {
+    if (candidates == 0) {
         _remainingPoints = 0;
         // Just return something; caller will see 0 points and not spawn further
         return _currentConfig.allowedTypes.front();
@@ -139,8 +138,13 @@ EnemyType WaveManager::chooseRandomEnemyType() {
 
     // Simple LCG-style RNG for repeatable behaviour
     _rngSeed = _rngSeed * 1664525u + 1013904223u;
-    unsigned int idx = _rngSeed % static_cast<unsigned int>(candidates.size());
-    return candidates[idx];
+    unsigned int idx = _rngSeed % candidates;
+
+    // idx-th affordable type
+    for (auto t : _currentConfig.allowedTypes) {
+        if (canAfford(t) && idx-- == 0) return t;
+    }
+    return _currentConfig.allowedTypes.front(); // unreachable
 }
 
 void WaveManager::startNextWave() {
@@ -151,10 +155,23 @@ void WaveManager::startNextWave() {
     _timeSinceSpawn = 0.f;
 }
 
+void WaveManager::hashState(StateHash& h) const {
+    h.add(_currentLevel);
+    h.add(_currentWave);
+    h.add(_waitingForPlayer);
+    h.add(_allWavesDone);
+    h.add(_remainingPoints);
+    h.add(_timeSinceSpawn);
+    h.add(_bossSpawnedThisWave);
+    h.add(static_cast<std::uint64_t>(_rngSeed));
+}
+
 void WaveManager::update(float dt,
     int currentEnemyCount,
     const std::function<void(EnemyType)>& spawnEnemy)
 {
+    TRACE_SCOPE("WaveManager::update");
+    ALLOC_SCOPE(Waves);
     if (_allWavesDone) return;
 
     // If we're waiting for the player to press E, do nothing
@@ -192,7 +209,9 @@ void WaveManager::update(float dt,
     if (_timeSinceSpawn < _currentConfig.spawnInterval) {
         return;
     }
-    _timeSinceSpawn = 0.f;
+    // Carry the overshoot into the next interval instead of dropping it,
+    // so spawn timing doesn't depend on the step size
+    _timeSinceSpawn -= _currentConfig.spawnInterval;
 
     // Boss spawn: on boss waves we spawn the boss first, then normal enemies
     if (_currentConfig.hasBoss && !_bossSpawnedThisWave) {
@@ -5,6 +5,8 @@
 #include <functional>
 #include "EnemyType.hpp"
 
+class StateHash;
+
 // A single wave configuration (point budget + which enemies can appear)
 struct WaveConfig {
     int   levelIndex = 0;      // 0..4
@@ -24,12 +26,17 @@ public:
     // Only defined ONCE here  remove any duplicates below
     static constexpr int kTotalLevels = 5;
     static constexpr int kWavesPerLevel = 5;
+    static constexpr size_t kMaxAllowedTypes = 10;   // non-boss EnemyTypes
+    static constexpr unsigned int kDefaultSeed = 123456u;
 
     WaveManager();
 
     // Reset to Level 1, Wave 1 waiting for player to press E
     void reset();
 
+    // Seed for the enemy type picks; same seed + same inputs = same waves
+    void setSeed(unsigned int seed) { _rngSeed = seed; }
+
     // Update the wave logic:
     //  - dt: delta time
     //  - currentEnemyCount: how many enemies are alive in the scene
@@ -45,10 +52,14 @@ public:
     int  getCurrentLevelIndex()    const { return _currentLevel; }     // 0-based
     int  getCurrentWaveIndex()     const { return _currentWave; }      // 0-based
     int  getWavesInCurrentLevel()  const { return kWavesPerLevel; }
+    int  getRemainingPoints()      const { return _remainingPoints; }
 
     // Called when the player presses E to begin / continue
     void startNextWave();
 
+    // Feed the wave counters, spawn timer and RNG state into a state checksum
+    void hashState(StateHash& h) const;
+
 private:
     int   _currentLevel = 0;   // 0..4
     int   _currentWave = 0;   // 0..4
@@ -64,5 +75,6 @@ private:
     unsigned int _rngSeed = 0u;
 
     void      setupCurrentWave();
+    bool      canAfford(EnemyType type) const;
     EnemyType chooseRandomEnemyType();
 };
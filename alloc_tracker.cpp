@@ -0,0 +1,84 @@
+// alloc_tracker.cpp
+#include "alloc_tracker.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::array<std::atomic<std::uint64_t>, AllocTracker::kScopeCount> s_counts{};
+thread_local AllocScope t_scope = AllocScope::Other;
+}
+
+// -------------------------
+// Global allocation hook
+// -------------------------
+
+#ifdef TILE_ENGINE_ALLOC_TRACKING
+
+void* operator new(std::size_t size) {
+    AllocTracker::on_alloc();
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+#endif
+
+// -------------------------
+// AllocTracker
+// -------------------------
+
+void AllocTracker::on_alloc() {
+    s_counts[static_cast<std::size_t>(t_scope)].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t AllocTracker::count(AllocScope scope) {
+    return s_counts[static_cast<std::size_t>(scope)].load(std::memory_order_relaxed);
+}
+
+std::uint64_t AllocTracker::sim_count() {
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < kScopeCount; ++i) {
+        if (is_sim(static_cast<AllocScope>(i))) sum += s_counts[i].load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+std::uint64_t AllocTracker::total() {
+    std::uint64_t sum = 0;
+    for (const auto& c : s_counts) sum += c.load(std::memory_order_relaxed);
+    return sum;
+}
+
+void AllocTracker::counts(Counts& out) {
+    for (std::size_t i = 0; i < kScopeCount; ++i) {
+        out[i] = s_counts[i].load(std::memory_order_relaxed);
+    }
+}
+
+AllocScope AllocTracker::current() {
+    return t_scope;
+}
+
+void AllocTracker::set_current(AllocScope scope) {
+    t_scope = scope;
+}
+
+const char* AllocTracker::name(AllocScope scope) {
+    switch (scope) {
+    case AllocScope::Other:     return "Other";
+    case AllocScope::Sim:       return "Sim";
+    case AllocScope::Waves:     return "Waves";
+    case AllocScope::TdEnemies: return "TD enemies";
+    case AllocScope::TdTurrets: return "TD turrets";
+    case AllocScope::TdBullets: return "TD bullets";
+    case AllocScope::Safehouse: return "Safehouse";
+    case AllocScope::Publish:   return "Publish";
+    case AllocScope::Render:    return "Render";
+    case AllocScope::Count:     break;
+    }
+    return "?";
+}
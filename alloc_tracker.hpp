@@ -0,0 +1,83 @@
+// alloc_tracker.hpp
+#pragma once
+// Heap allocation counting, for catching allocation churn in the sim.
+//
+// Built in with -DTILE_ENGINE_ALLOC_TRACKING=ON (set on tile_level and
+// passed on to everything linking it): a global operator new hook counts
+// every allocation against the calling thread's current AllocScope.
+// ALLOC_SCOPE(scope) sets that scope until the end of the block; nested
+// scopes win, and threads start in AllocScope::Other.
+//
+// Without the option the hook isn't compiled, ALLOC_SCOPE does nothing and
+// every count stays 0 (check AllocTracker::kEnabled).
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class AllocScope : std::uint8_t {
+    Other,        // untagged (loading, tools, libraries)
+    Sim,          // sim step outside the phases below
+    Waves,        // WaveManager
+    TdEnemies,    // TD phases
+    TdTurrets,
+    TdBullets,
+    Safehouse,    // invaders + enemy bullets
+    Publish,      // filling frame snapshots (incl. HUD text)
+    Render,       // render thread
+
+    Count
+};
+
+class AllocTracker {
+public:
+#ifdef TILE_ENGINE_ALLOC_TRACKING
+    static constexpr bool kEnabled = true;
+#else
+    static constexpr bool kEnabled = false;
+#endif
+
+    static constexpr std::size_t kScopeCount = static_cast<std::size_t>(AllocScope::Count);
+    using Counts = std::array<std::uint64_t, kScopeCount>;
+
+    // Called by the operator new hook
+    static void on_alloc();
+
+    // Allocations so far (since process start) in one scope, in every
+    // scope the sim owns (Sim..Publish), or in total
+    static std::uint64_t count(AllocScope scope);
+    static std::uint64_t sim_count();
+    static std::uint64_t total();
+    static void          counts(Counts& out);
+
+    static AllocScope current();
+    static void       set_current(AllocScope scope);
+
+    static const char* name(AllocScope scope);
+    static bool        is_sim(AllocScope scope) {
+        return scope != AllocScope::Other && scope != AllocScope::Render;
+    }
+};
+
+// Counts this thread's allocations against `scope` until destroyed
+class AllocScopeGuard {
+public:
+    explicit AllocScopeGuard(AllocScope scope) : _previous(AllocTracker::current()) {
+        AllocTracker::set_current(scope);
+    }
+    ~AllocScopeGuard() { AllocTracker::set_current(_previous); }
+
+    AllocScopeGuard(const AllocScopeGuard&) = delete;
+    AllocScopeGuard& operator=(const AllocScopeGuard&) = delete;
+
+private:
+    AllocScope _previous;
+};
+
+#ifdef TILE_ENGINE_ALLOC_TRACKING
+#define ALLOC_SCOPE_CONCAT_INNER(a, b) a##b
+#define ALLOC_SCOPE_CONCAT(a, b) ALLOC_SCOPE_CONCAT_INNER(a, b)
+#define ALLOC_SCOPE(scope) const AllocScopeGuard ALLOC_SCOPE_CONCAT(_allocScope, __LINE__)(AllocScope::scope)
+#else
+#define ALLOC_SCOPE(scope) ((void)0)
+#endif
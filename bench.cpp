@@ -0,0 +1,597 @@
+// bench.cpp
+// Micro/meso benchmarks for the simulation hot paths, with synthetic loads
+// far past what a normal run reaches.
+//
+// Each scenario builds its own state (untimed), then steps it for a fixed
+// number of ticks (after a few untimed warm-up ticks). A run repeats that a few times and reports the median:
+//   ns/tick      wall time of one step
+//   ns/entity    ns/tick divided by the entities the step processed
+//   allocs/tick  heap allocations made inside the timed steps (needs a
+//                build configured with -DTILE_ENGINE_ALLOC_TRACKING=ON)
+//
+// Usage:
+//   tile_engine_bench [--filter text] [--ticks N] [--reps R]
+//                     [--baseline file] [--tolerance pct] [--write-baseline file]
+//
+// --baseline compares against a previous --write-baseline run (the
+// committed one is bench_baseline.txt) and exits with 1 if any scenario
+// allocates more per tick or has no baseline row. Allocation counts don't
+// depend on the machine; timings vary up to ~2x between runs, so they are
+// only gated when asked for: --tolerance fails any scenario more than
+// `pct` percent slower (same machine and build type only).
+//
+// Scenarios:
+//   td_enemies_*   TDEnemy::update along the td_1 path
+//   td_turrets_*   TDTurret::update (cooldown + targeting) against 1000 enemies
+//   td_bullets_5k  TDBullet::update (movement + hits) against 100 enemies
+//   td_waves       TowerDefenceScene::tick_simulation with WaveManager spawning
+//   sh_invaders_*  SafehouseScene::tick_simulation (invaders + enemy bullets)
+//   level_pan_2k   LevelSystem::render into an offscreen 1280x720 target
+//                  while the view pans across a generated 2048x2048 level;
+//                  fails (exit 1) if draw calls or resident chunks ever go
+//                  past what the view size allows
+
+#include "EnemyStats.hpp"
+#include "alloc_tracker.hpp"
+#include "game_parameters.hpp"
+#include "game_session.hpp"
+#include "scenes.hpp"
+#include "tile_level_loader/level_system.hpp"
+
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using param = Parameters;
+
+namespace {
+
+const float kTileSize = 50.f;
+
+// One benchmark: setup() builds fresh state, tick() steps it once and
+// returns how many entities that step processed. valid() (optional) says
+// whether the state is still the intended load after the timed ticks;
+// check() (optional) is a property the code under test must keep, and
+// the bench fails if it doesn't.
+struct Scenario {
+    std::string                    name;
+    std::function<void()>          setup;
+    std::function<std::size_t()>   tick;
+    std::function<bool()>          valid;
+    std::function<bool()>          check;
+};
+
+struct Result {
+    std::string name;
+    double      nsPerTick = 0.0;
+    double      nsPerEntity = 0.0;
+    double      entities = 0.0;
+    double      allocsPerTick = 0.0;
+    bool        failed = false;   // check() didn't hold
+};
+
+// td_1 path, loaded once and shared by every TD scenario
+const std::vector<sf::Vector2f>& td_path() {
+    static std::vector<sf::Vector2f> path;
+    if (path.empty()) {
+        LevelSystem level;
+        level.load_level(param::td_1, kTileSize);
+        TowerDefenceScene::build_enemy_path(level, path);
+    }
+    return path;
+}
+
+// `count` enemies of mixed types spread evenly along the path
+void spread_enemies(std::vector<TDEnemy>& enemies, std::size_t count) {
+    static const EnemyType kTypes[] = { EnemyType::Basic, EnemyType::Fast, EnemyType::Tank };
+    const auto& path = td_path();
+
+    enemies.clear();
+    enemies.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const EnemyType type = kTypes[i % 3];
+        enemies.emplace_back(type, path.front());
+
+        // One big step moves it part way along (stops short of the end)
+        const float segments = static_cast<float>(path.size() - 1);
+        const float fraction = static_cast<float>(i % 97) / 100.f;
+        const float speed = get_enemy_stats(type).speed;
+        enemies.back().update(fraction * segments * kTileSize / speed, path, kTileSize);
+    }
+}
+
+// -------------------------
+// TD entity scenarios
+// -------------------------
+
+Scenario td_enemies(const std::string& name, std::size_t count) {
+    auto enemies = std::make_shared<std::vector<TDEnemy>>();
+    Scenario s;
+    s.name = name;
+    s.setup = [enemies, count] { spread_enemies(*enemies, count); };
+    s.tick = [enemies] {
+        const auto& path = td_path();
+        for (auto& e : *enemies) {
+            if (e.update(param::time_step, path, kTileSize)) {
+                e = TDEnemy(e.getType(), path.front()); // escaped: back to the start
+            }
+        }
+        return enemies->size();
+    };
+    return s;
+}
+
+Scenario td_turrets(const std::string& name, std::size_t count) {
+    struct State {
+        std::vector<TDEnemy>  enemies;
+        std::vector<TDTurret> turrets;
+    };
+    auto st = std::make_shared<State>();
+
+    Scenario s;
+    s.name = name;
+    s.setup = [st, count] {
+        spread_enemies(st->enemies, 1000);
+
+        // Cycle through every tile; turrets may share one
+        st->turrets.clear();
+        st->turrets.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const sf::Vector2i grid(static_cast<int>(i % 16), static_cast<int>((i / 16) % 12));
+            st->turrets.emplace_back(grid,
+                sf::Vector2f(grid.x * kTileSize, grid.y * kTileSize), kTileSize);
+        }
+    };
+    s.tick = [st] {
+        sf::Vector2f pos, dir;
+        for (auto& t : st->turrets) {
+            t.update(param::time_step, st->enemies, pos, dir); // shots are dropped
+        }
+        return st->turrets.size();
+    };
+    return s;
+}
+
+Scenario td_bullets(const std::string& name, std::size_t count) {
+    struct State {
+        std::vector<TDEnemy>  enemies;
+        std::vector<TDBullet> bullets;
+        unsigned              rng = 1u;
+
+        // Fired from a random path node in a random direction
+        TDBullet make_bullet() {
+            const auto& path = td_path();
+            rng = rng * 1664525u + 1013904223u;
+            const sf::Vector2f from = path[(rng >> 8) % path.size()];
+            const float angle = static_cast<float>((rng >> 4) % 628) / 100.f;
+            return TDBullet(from, { std::cos(angle), std::sin(angle) });
+        }
+    };
+    auto st = std::make_shared<State>();
+
+    Scenario s;
+    s.name = name;
+    s.setup = [st, count] {
+        spread_enemies(st->enemies, 100);
+        st->rng = 1u;
+        st->bullets.clear();
+        st->bullets.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) st->bullets.push_back(st->make_bullet());
+    };
+    s.tick = [st] {
+        // Spent bullets are refired and dead enemies revived so the load
+        // stays constant
+        for (auto& b : st->bullets) {
+            if (!b.update(param::time_step, st->enemies)) b = st->make_bullet();
+        }
+        for (auto& e : st->enemies) {
+            if (e.isDead()) e = TDEnemy(e.getType(), e.getPosition());
+        }
+        return st->bullets.size();
+    };
+    return s;
+}
+
+// -------------------------
+// Scene scenarios
+// -------------------------
+
+// Default turret layout from the headless runner
+const sf::Vector2i kWaveTurrets[] = {
+    { 4, 3 }, { 8, 3 }, { 11, 3 },
+    { 5, 5 }, { 9, 5 }, { 12, 5 },
+    { 4, 7 }, { 8, 7 }
+};
+
+Scenario td_waves(const std::string& name) {
+    auto session = std::make_shared<std::unique_ptr<GameSession>>();
+    auto escaped = std::make_shared<std::vector<int>>();
+    auto tick_td = [session, escaped] {
+        auto* td = static_cast<TowerDefenceScene*>((*session)->tower_defence.get());
+        if (td->isWaitingForPlayer()) td->start_next_wave();
+        td->tick_simulation(param::time_step);
+
+        // No Safehouse here: throw escapes away
+        td->flush_escaped_enemies();
+        escaped->clear();
+        td->drain_escaped_enemies(*escaped);
+        return td->get_enemy_count() + td->get_bullet_count();
+    };
+
+    Scenario s;
+    s.name = name;
+    s.setup = [session, escaped, tick_td] {
+        *session = std::make_unique<GameSession>();
+        escaped->reserve(TowerDefenceScene::kEscapeQueueSize);
+        auto* td = static_cast<TowerDefenceScene*>((*session)->tower_defence.get());
+        td->load();
+        for (const auto& grid : kWaveTurrets) td->place_turret_at(grid);
+
+        // Get a few waves in so there's something on the path
+        for (int i = 0; i < 1800; ++i) tick_td();
+    };
+    s.tick = tick_td;
+    return s;
+}
+
+Scenario sh_invaders(const std::string& name, std::size_t count) {
+    auto session = std::make_shared<std::unique_ptr<GameSession>>();
+
+    Scenario s;
+    s.name = name;
+    s.setup = [session, count] {
+        *session = std::make_unique<GameSession>();
+        auto* sh = static_cast<SafehouseScene*>((*session)->safehouse.get());
+        sh->load();
+
+        // Melee and ranged, so enemy bullets get exercised too
+        std::vector<int> types(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            types[i] = static_cast<int>((i % 4 == 3) ? EnemyType::shortRanged : EnemyType::Basic);
+        }
+        sh->spawn_invaders(types);
+    };
+    s.tick = [session] {
+        auto* sh = static_cast<SafehouseScene*>((*session)->safehouse.get());
+        sh->tick_simulation(param::time_step);
+        return sh->get_invader_count() + sh->get_enemy_bullet_count();
+    };
+    // Invaders are cleared once the player dies (too many ticks)
+    s.valid = [session] {
+        return !static_cast<SafehouseScene*>((*session)->safehouse.get())->is_player_dead();
+    };
+    return s;
+}
+
+// -------------------------
+// Level rendering
+// -------------------------
+
+// Square level of `side` tiles: a wall border, an enemy lane every 64th
+// row and scattered walls, so every chunk has a mix of colours
+std::string write_big_level(int side) {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / ("tile_engine_bench_" + std::to_string(side) + ".txt")).string();
+    std::ofstream f(path);
+    if (!f.good()) throw std::string("Couldn't write bench level: ") + path;
+
+    std::string row(static_cast<std::size_t>(side) + 1, ' ');
+    row.back() = '\n';
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            char c = ' ';
+            if (x == 0 || y == 0 || x == side - 1 || y == side - 1) c = 'w';
+            else if (y % 64 == 32) c = '+';
+            else if ((x * 7 + y * 13) % 29 == 0) c = 'w';
+            row[static_cast<std::size_t>(x)] = c;
+        }
+        if (y == 1) row[1] = 's';
+        if (y == side - 2) row[static_cast<std::size_t>(side) - 2] = 'e';
+        f << row;
+    }
+    if (!f.good()) throw std::string("Couldn't write bench level: ") + path;
+    return path;
+}
+
+Scenario level_pan(const std::string& name, int side) {
+    struct State {
+        LevelSystem       level;
+        sf::RenderTexture target;
+        bool              hasTarget = false;
+        sf::View          view;
+        float             dir = 1.f;     // +1 panning right, -1 left
+        std::size_t       maxDrawCalls = 0;
+        std::size_t       maxResident = 0;
+    };
+    auto st = std::make_shared<State>();
+    const sf::Vector2f screen(1280.f, 720.f);
+
+    // Most chunks a screen-sized view can touch (it can straddle an edge
+    // on both axes), and that plus the resident margin all round
+    const float chunk = kTileSize * LevelSystem::kChunkTiles;
+    const std::size_t spanX = static_cast<std::size_t>(screen.x / chunk) + 2;
+    const std::size_t spanY = static_cast<std::size_t>(screen.y / chunk) + 2;
+    const std::size_t margin = 2 * LevelSystem::kResidentMargin;
+    const std::size_t maxDrawCalls = spanX * spanY;
+    const std::size_t maxResident = (spanX + margin) * (spanY + margin);
+
+    Scenario s;
+    s.name = name;
+    s.setup = [st, side, screen] {
+        static const std::string path = write_big_level(side);   // once per run
+        st->level.load_level(path, kTileSize);
+        if (!st->hasTarget) {
+            st->hasTarget = st->target.create(static_cast<unsigned>(screen.x), static_cast<unsigned>(screen.y));
+        }
+        st->view = sf::View(screen * 0.5f, screen);
+        st->dir = 1.f;
+        st->maxDrawCalls = 0;
+        st->maxResident = 0;
+    };
+    s.tick = [st, screen] {
+        // Pan across the level in rows, a screen height further down each
+        // time, back to the top once past the bottom. The step isn't a
+        // divisor of the chunk size, so edges get crossed at every offset.
+        const sf::Vector2f world = st->level.get_world_size();
+        sf::Vector2f centre = st->view.getCenter() + sf::Vector2f(397.f * st->dir, 0.f);
+        if (centre.x > world.x - screen.x * 0.5f || centre.x < screen.x * 0.5f) {
+            st->dir = -st->dir;
+            centre.y += screen.y;
+            if (centre.y > world.y) centre.y = screen.y * 0.5f;
+        }
+        st->view.setCenter(centre);
+
+        st->target.setView(st->view);
+        st->target.clear();
+        const std::size_t drawCalls = st->level.render(st->target);
+        st->target.display();
+
+        st->maxDrawCalls = std::max(st->maxDrawCalls, drawCalls);
+        st->maxResident = std::max(st->maxResident, st->level.get_resident_chunks());
+        return drawCalls;
+    };
+    s.check = [st, maxDrawCalls, maxResident] {
+        if (!st->hasTarget) {
+            std::cerr << "[bench] level_pan: couldn't create the offscreen target\n";
+            return false;
+        }
+        if (st->maxDrawCalls > maxDrawCalls || st->maxResident > maxResident) {
+            std::cerr << "[bench] level_pan: " << st->maxDrawCalls << " draw calls, "
+                << st->maxResident << " resident chunks (limits " << maxDrawCalls
+                << ", " << maxResident << ")\n";
+            return false;
+        }
+        return true;
+    };
+    return s;
+}
+
+std::vector<Scenario> make_scenarios() {
+    std::vector<Scenario> all;
+    all.push_back(td_enemies("td_enemies_100", 100));
+    all.push_back(td_enemies("td_enemies_1k", 1000));
+    all.push_back(td_enemies("td_enemies_10k", 10000));
+    all.push_back(td_turrets("td_turrets_50", 50));
+    all.push_back(td_turrets("td_turrets_500", 500));
+    all.push_back(td_bullets("td_bullets_5k", 5000));
+    all.push_back(td_waves("td_waves"));
+    all.push_back(sh_invaders("sh_invaders_100", 100));
+    all.push_back(sh_invaders("sh_invaders_1k", 1000));
+    all.push_back(level_pan("level_pan_2k", 2048));
+    return all;
+}
+
+// -------------------------
+// Running + reporting
+// -------------------------
+
+Result run(const Scenario& s, int ticks, int reps) {
+    std::vector<Result> samples;
+    for (int r = 0; r < reps; ++r) {
+        // Scene setup logs; keep it out of the table
+        std::streambuf* out = std::cout.rdbuf(nullptr);
+        s.setup();
+        std::cout.rdbuf(out);
+
+        // A few untimed steps to warm caches and grow any buffers
+        for (int i = 0; i < std::max(ticks / 10, 1); ++i) s.tick();
+
+        std::size_t entities = 0;
+        const std::uint64_t allocsBefore = AllocTracker::total();
+        sf::Clock clock;
+        for (int i = 0; i < ticks; ++i) entities += s.tick();
+        const double ns = static_cast<double>(clock.getElapsedTime().asMicroseconds()) * 1000.0;
+        const std::uint64_t allocs = AllocTracker::total() - allocsBefore;
+
+        if (s.valid && !s.valid()) {
+            std::cerr << "[bench] " << s.name << ": load changed during the run"
+                << " (try fewer --ticks)\n";
+        }
+        const bool failed = s.check && !s.check();
+
+        Result res;
+        res.name = s.name;
+        res.nsPerTick = ns / ticks;
+        res.entities = static_cast<double>(entities) / ticks;
+        res.nsPerEntity = (entities > 0) ? ns / static_cast<double>(entities) : 0.0;
+        res.allocsPerTick = static_cast<double>(allocs) / ticks;
+        res.failed = failed;
+        samples.push_back(res);
+    }
+
+    std::sort(samples.begin(), samples.end(),
+        [](const Result& a, const Result& b) { return a.nsPerTick < b.nsPerTick; });
+    Result median = samples[samples.size() / 2];
+    for (const auto& sample : samples) median.failed = median.failed || sample.failed;
+    return median;
+}
+
+// name -> { ns/tick, allocs/tick }
+using Baseline = std::map<std::string, std::pair<double, double>>;
+
+bool load_baseline(const std::string& path, Baseline& out) {
+    std::ifstream f(path);
+    if (!f.good()) {
+        std::cerr << "Couldn't open baseline file: " << path << "\n";
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ss(line);
+        std::string name;
+        double ns = 0.0, allocs = 0.0;
+        if (ss >> name >> ns >> allocs) out[name] = { ns, allocs };
+    }
+    return true;
+}
+
+bool write_baseline(const std::string& path, const std::vector<Result>& results, int ticks, int reps) {
+    std::ofstream f(path);
+    if (!f.good()) {
+        std::cerr << "Couldn't write baseline file: " << path << "\n";
+        return false;
+    }
+
+    f << "# tile_engine_bench baseline (" << ticks << " ticks x " << reps << " reps, median)\n"
+        << "# Timings are machine-specific: rewrite this on the machine you compare on.\n"
+        << "# scenario ns_per_tick allocs_per_tick\n";
+    for (const auto& r : results) {
+        f << r.name << " " << std::fixed << std::setprecision(1) << r.nsPerTick
+            << " " << std::setprecision(2) << r.allocsPerTick << "\n";
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::string baselinePath;
+    std::string writePath;
+    double      tolerance = -1.0;   // < 0: timings aren't gated
+    int         ticks = 300;
+    int         reps = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        }
+        else if (arg == "--ticks" && i + 1 < argc) {
+            ticks = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--reps" && i + 1 < argc) {
+            reps = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--baseline" && i + 1 < argc) {
+            baselinePath = argv[++i];
+        }
+        else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = std::stod(argv[++i]);
+        }
+        else if (arg == "--write-baseline" && i + 1 < argc) {
+            writePath = argv[++i];
+        }
+        else {
+            std::cerr << "Usage: " << argv[0]
+                << " [--filter text] [--ticks N] [--reps R]"
+                << " [--baseline file] [--tolerance pct] [--write-baseline file]\n";
+            return 1;
+        }
+    }
+
+    Baseline baseline;
+    if ((!baselinePath.empty() || !writePath.empty()) && !AllocTracker::kEnabled) {
+        std::cerr << "--baseline / --write-baseline need a build configured with"
+            << " -DTILE_ENGINE_ALLOC_TRACKING=ON\n";
+        return 1;
+    }
+    if (!baselinePath.empty() && !load_baseline(baselinePath, baseline)) {
+        return 1;
+    }
+
+    // Load the level up front so its allocations and log lines aren't
+    // part of the first scenario
+    std::streambuf* out = std::cout.rdbuf(nullptr);
+    td_path();
+    std::cout.rdbuf(out);
+
+    std::vector<Result> results;
+    bool regressed = false;
+    bool failed = false;
+
+    std::cout << "\n" << std::left << std::setw(18) << "scenario"
+        << std::right << std::setw(10) << "entities"
+        << std::setw(14) << "ns/tick"
+        << std::setw(12) << "ns/entity"
+        << std::setw(13) << "allocs/tick";
+    if (!baseline.empty()) std::cout << std::setw(14) << "vs baseline";
+    std::cout << "\n";
+
+    for (const auto& s : make_scenarios()) {
+        if (!filter.empty() && s.name.find(filter) == std::string::npos) continue;
+
+        const Result r = run(s, ticks, reps);
+        results.push_back(r);
+
+        std::cout << std::left << std::setw(18) << r.name << std::right
+            << std::fixed << std::setprecision(0)
+            << std::setw(10) << r.entities
+            << std::setw(14) << r.nsPerTick
+            << std::setprecision(1)
+            << std::setw(12) << r.nsPerEntity
+            << std::setprecision(2)
+            << std::setw(13) << r.allocsPerTick;
+
+        auto it = baseline.find(r.name);
+        if (!baseline.empty() && it == baseline.end()) {
+            std::cout << "  NOT IN BASELINE";
+            regressed = true;
+        }
+        else if (it != baseline.end()) {
+            const double base = it->second.first;
+            const double delta = (base > 0.0) ? (r.nsPerTick - base) * 100.0 / base : 0.0;
+            const bool slower = tolerance >= 0.0 && delta > tolerance;
+            const bool moreAllocs = r.allocsPerTick > it->second.second + 0.005;
+
+            std::cout << std::setw(12) << std::showpos << std::setprecision(1) << delta
+                << std::noshowpos << " %"
+                << (slower ? "  SLOWER" : "")
+                << (moreAllocs ? "  MORE ALLOCS" : "");
+            regressed = regressed || slower || moreAllocs;
+        }
+        if (r.failed) std::cout << "  FAILED";
+        failed = failed || r.failed;
+        std::cout << "\n";
+    }
+
+    if (!writePath.empty() && !write_baseline(writePath, results, ticks, reps)) {
+        return 1;
+    }
+
+    if (failed) {
+        std::cout << "\n[bench] a scenario's check failed (see above)\n";
+        return 1;
+    }
+    if (regressed) {
+        std::cout << "\n[bench] regression against " << baselinePath;
+        if (tolerance >= 0.0) std::cout << " (tolerance " << tolerance << " %)";
+        std::cout << "\n";
+        return 1;
+    }
+    return 0;
+}
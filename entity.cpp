@@ -11,6 +11,12 @@ void Entity::set_position(const sf::Vector2f& pos) {
     _shape->setPosition(_position);
 }
 
+// Place the entity without interpolating from its old position
+void Entity::teleport(const sf::Vector2f& pos) {
+    set_position(pos);
+    _prev_position = pos;
+}
+
 // Move by a delta and update the SFML shape
 void Entity::move(const sf::Vector2f& delta) {
     _position += delta;
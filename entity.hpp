@@ -4,6 +4,8 @@
 #include <SFML/Graphics.hpp>
 #include <memory>
 
+struct FrameSnapshot;
+
 class Entity {
 public:
     // Must be constructed with a Shape (CircleShape, RectangleShape, etc.)
@@ -14,15 +16,22 @@ public:
     // Called once per frame  override in derived classes
     virtual void update(const float& dt);
 
-    // Draw this entity  subclasses must implement
-    virtual void render(sf::RenderWindow& window) const = 0;
+    // Add this entity to the frame snapshot  subclasses must implement
+    virtual void publish(FrameSnapshot& out) const = 0;
 
     // Position helpers
     sf::Vector2f get_position() const { return _position; }
     void set_position(const sf::Vector2f& pos);
+    void teleport(const sf::Vector2f& pos);
     void move(const sf::Vector2f& delta);
 
+    // Render interpolation: remember the position before a sim step so the
+    // renderer can blend between it and the current position
+    void store_previous_position() { _prev_position = _position; }
+    sf::Vector2f get_previous_position() const { return _prev_position; }
+
 protected:
     std::unique_ptr<sf::Shape> _shape;  // SFML shape we draw
     sf::Vector2f _position{ 0.f, 0.f }; // cached world position
+    sf::Vector2f _prev_position{ 0.f, 0.f }; // position at start of last step
 };
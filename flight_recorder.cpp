@@ -0,0 +1,110 @@
+// flight_recorder.cpp
+#include "flight_recorder.hpp"
+#include "trace.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+void FlightRecorder::note_frame_time(float ms) {
+    _frameMs.store(ms, std::memory_order_relaxed);
+
+    const float threshold = get_threshold_ms();
+    if (threshold > 0.f && ms > threshold) {
+        // Don't downgrade a manual request
+        int expected = kRequestNone;
+        _request.compare_exchange_strong(expected, kRequestRenderFrame, std::memory_order_relaxed);
+    }
+}
+
+void FlightRecorder::record(const FlightFrame& frame) {
+    FlightFrame& slot = _frames[_next];
+    slot = frame;
+    slot.renderMs = _frameMs.load(std::memory_order_relaxed);
+    _next = (_next + 1) % kFrames;
+    if (_count < kFrames) ++_count;
+
+    const int   request = _request.exchange(kRequestNone, std::memory_order_relaxed);
+    const float threshold = get_threshold_ms();
+
+    if (request == kRequestManual) {
+        write_dump(frame.tick, "requested");
+        return;
+    }
+
+    // Automatic dumps: only once the last one's context has mostly scrolled out
+    if (threshold <= 0.f || _dumps >= kMaxDumps || frame.tick < _quietUntil) return;
+
+    const char* reason = nullptr;
+    if (frame.updateMs > threshold) reason = "slow sim step";
+    else if (request == kRequestRenderFrame) reason = "slow render frame";
+    if (!reason || !write_dump(frame.tick, reason)) return;
+
+    ++_dumps;
+    _quietUntil = frame.tick + kFrames / 2;
+}
+
+bool FlightRecorder::write_dump(std::uint64_t tick, const char* reason) {
+    if (_writing.exchange(true, std::memory_order_acquire)) {
+        std::cout << "[FlightRecorder] " << reason << " at tick " << tick
+            << ", still writing the last dump, skipped\n";
+        return false;
+    }
+
+    // Copy the ring in order (a struct copy) so the sim can carry on
+    // recording while the worker writes
+    const std::size_t first = (_next + kFrames - _count) % kFrames;
+    for (std::size_t i = 0; i < _count; ++i) _dumpFrames[i] = _frames[(first + i) % kFrames];
+    _dumpCount = _count;
+
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "_%llu", static_cast<unsigned long long>(tick));
+    const std::string base = _prefix + suffix;
+    const float threshold = get_threshold_ms();
+
+    _writer.run([this, base, reason, tick, threshold] {
+        if (write_csv(base + ".csv", reason, threshold, _dumpFrames.data(), _dumpCount)) {
+            std::cout << "[FlightRecorder] " << reason << " at tick " << tick
+                << ", wrote " << base << ".csv\n";
+            if (Trace::is_enabled()) {
+                Trace::write_chrome_json(base + ".trace.json");
+            }
+        }
+        _writing.store(false, std::memory_order_release);
+    });
+    return true;
+}
+
+bool FlightRecorder::dump(const std::string& path, const char* reason) const {
+    std::array<FlightFrame, kFrames> frames;
+    const std::size_t first = (_next + kFrames - _count) % kFrames;
+    for (std::size_t i = 0; i < _count; ++i) frames[i] = _frames[(first + i) % kFrames];
+    return write_csv(path, reason, get_threshold_ms(), frames.data(), _count);
+}
+
+bool FlightRecorder::write_csv(const std::string& path, const char* reason, float thresholdMs,
+    const FlightFrame* frames, std::size_t count) {
+    std::ofstream f(path);
+    if (!f.good()) {
+        std::cerr << "[FlightRecorder] Couldn't open " << path << " for writing\n";
+        return false;
+    }
+
+    f << "# flight recorder: " << reason << ", threshold " << thresholdMs << " ms\n"
+        << "tick,update_ms,enemies_ms,turrets_ms,bullets_ms,invaders_ms,enemy_bullets_ms,render_ms,"
+        << "entities,bullets,td_enemies,td_turrets,invaders,allocs,"
+        << "level,wave,remaining_points,waiting\n";
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const FlightFrame& fr = frames[i];
+        f << fr.tick << ","
+            << fr.updateMs << "," << fr.enemiesMs << "," << fr.turretsMs << ","
+            << fr.bulletsMs << "," << fr.invadersMs << "," << fr.enemyBulletsMs << ","
+            << fr.renderMs << ","
+            << fr.entities << "," << fr.bullets << "," << fr.enemies << ","
+            << fr.turrets << "," << fr.invaders << "," << fr.allocs << ","
+            << fr.level + 1 << "," << fr.wave + 1 << "," << fr.remainingPoints << ","
+            << (fr.waitingForPlayer ? 1 : 0) << "\n";
+    }
+    return f.good();
+}
@@ -0,0 +1,121 @@
+// flight_recorder.hpp
+#pragma once
+// Flight recorder: the last few seconds of sim steps (timings, live counts,
+// wave state) in a fixed ring, written to a file when something goes wrong.
+//
+// The sim thread records one FlightFrame per step. A step slower than the
+// threshold, a render frame slower than it (reported by the render thread)
+// or an explicit request_dump() writes the ring, oldest step first, to
+// "<prefix>_<tick>.csv" - plus "<prefix>_<tick>.trace.json" when tracing
+// is on - so a hitch in the field comes with what led up to it.
+//
+// Recording is a struct copy with no allocation. A dump copies the ring on
+// the sim thread right after the slow step and hands the file writing to
+// a background thread, so the sim doesn't stall on disk at the moment
+// it's being watched; a dump due while the last one is still being
+// written is dropped. After an automatic dump the next one waits until
+// half the ring is new, and a run writes at most kMaxDumps of them.
+//
+// Phase times are for the step itself: a phase that didn't run in that
+// step (other game mode, skipped by sim LOD) reads 0.
+
+#include "sim_worker.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// One sim step
+struct FlightFrame {
+    std::uint64_t tick = 0;
+
+    // Times, in milliseconds
+    float updateMs = 0.f;          // whole step
+    float enemiesMs = 0.f;         // TD phases
+    float turretsMs = 0.f;
+    float bulletsMs = 0.f;
+    float invadersMs = 0.f;        // Safehouse phases
+    float enemyBulletsMs = 0.f;
+    float renderMs = 0.f;          // newest render frame when the step ended
+
+    // Live counts
+    std::uint32_t entities = 0;    // everything alive in both scenes
+    std::uint32_t bullets = 0;
+    std::uint32_t enemies = 0;     // TD
+    std::uint32_t turrets = 0;
+    std::uint32_t invaders = 0;    // Safehouse
+    std::uint32_t allocs = 0;      // alloc tracking builds only
+
+    // Wave state (0-based, like WaveManager)
+    int  level = 0;
+    int  wave = 0;
+    int  remainingPoints = 0;
+    bool waitingForPlayer = false;
+};
+
+class FlightRecorder {
+public:
+    static constexpr std::size_t kFrames = 300;   // 5 s at 60 Hz
+    static constexpr int         kMaxDumps = 8;   // automatic dumps per run
+
+    // Step or render frame time that counts as a hitch (ms); 0 = off.
+    // Any thread.
+    void  set_threshold_ms(float ms) { _thresholdMs.store(ms, std::memory_order_relaxed); }
+    float get_threshold_ms() const { return _thresholdMs.load(std::memory_order_relaxed); }
+
+    // Dump file names start with this (may include a directory).
+    // Set before the sim starts.
+    void set_dump_prefix(const std::string& prefix) { _prefix = prefix; }
+
+    // Render thread: newest frame time. A frame over the threshold dumps
+    // after the sim's next step.
+    void note_frame_time(float ms);
+
+    // Any thread: dump after the sim's next step, whatever the timings
+    void request_dump() { _request.store(kRequestManual, std::memory_order_relaxed); }
+
+    // Sim thread: store one step, then dump if it was a hitch
+    void record(const FlightFrame& frame);
+
+    // Write the recorded steps, oldest first, as CSV, on the calling
+    // thread. Returns false if the file couldn't be written.
+    bool dump(const std::string& path, const char* reason) const;
+
+    // Block until a dump being written in the background is done
+    void wait_for_dumps() { _writer.wait(); }
+
+    std::size_t size() const { return _count; }
+    int         dumps_written() const { return _dumps; }
+
+private:
+    static constexpr int kRequestNone = 0;
+    static constexpr int kRequestRenderFrame = 1;
+    static constexpr int kRequestManual = 2;
+
+    std::array<FlightFrame, kFrames> _frames{};
+    std::size_t                      _next = 0;
+    std::size_t                      _count = 0;
+
+    std::atomic<float> _thresholdMs{ 0.f };
+    std::atomic<float> _frameMs{ 0.f };
+    std::atomic<int>   _request{ kRequestNone };
+
+    std::string   _prefix = "hitch";
+    std::uint64_t _quietUntil = 0;   // no automatic dump before this tick
+    int           _dumps = 0;
+
+    // Copy of the ring the background write works from
+    std::array<FlightFrame, kFrames> _dumpFrames{};
+    std::size_t                      _dumpCount = 0;
+    std::atomic<bool>                _writing{ false };
+
+    // Returns false (and writes nothing) if the last dump is still going
+    bool write_dump(std::uint64_t tick, const char* reason);
+    static bool write_csv(const std::string& path, const char* reason, float thresholdMs,
+        const FlightFrame* frames, std::size_t count);
+
+    // Last, so it finishes a pending write before the buffers go away
+    SimWorker _writer;
+};
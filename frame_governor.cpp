@@ -0,0 +1,74 @@
+// frame_governor.cpp
+#include "frame_governor.hpp"
+
+namespace {
+// Weight of the newest frame in the moving averages
+constexpr float kSmoothing = 0.1f;
+}
+
+int FrameGovernor::update(float frameMs, float busyMs) {
+    if (_budgetMs <= 0.f) return _level;
+
+    if (_frameAvg <= 0.f) {
+        _frameAvg = frameMs;
+        _busyAvg = busyMs;
+    }
+    else {
+        _frameAvg += (frameMs - _frameAvg) * kSmoothing;
+        _busyAvg += (busyMs - _busyAvg) * kSmoothing;
+    }
+
+    // Let the averages catch up with the last change before judging it
+    if (_settle > 0) {
+        --_settle;
+        return _level;
+    }
+
+    const bool over = _frameAvg > _budgetMs * kDegradeAt;
+    const bool headroom = _frameAvg < _budgetMs * kRecoverFrameAt &&
+        _busyAvg < _budgetMs * kRecoverBusyAt;
+
+    if (over) {
+        _underFrames = 0;
+        if (++_overFrames >= kDegradeFrames && _level < kMaxLevel) {
+            ++_level;
+            _overFrames = 0;
+            _settle = kSettleFrames;
+        }
+    }
+    else if (headroom) {
+        _overFrames = 0;
+        if (++_underFrames >= kRecoverFrames && _level > Full) {
+            --_level;
+            _underFrames = 0;
+            _settle = kSettleFrames;
+        }
+    }
+    else {
+        // Inside the band: hold
+        _overFrames = 0;
+        _underFrames = 0;
+    }
+    return _level;
+}
+
+void FrameGovernor::reset() {
+    _frameAvg = 0.f;
+    _busyAvg = 0.f;
+    _level = Full;
+    _overFrames = 0;
+    _underFrames = 0;
+    _settle = 0;
+}
+
+const char* FrameGovernor::name(int level) {
+    switch (level) {
+    case Full:           return "full";
+    case NoHitFlash:     return "no hit flash";
+    case SlowBackground: return "slow background";
+    case BatchedBullets: return "batched bullets";
+    case SlowHud:        return "slow hud";
+    default:             break;
+    }
+    return "?";
+}
@@ -0,0 +1,82 @@
+// frame_governor.hpp
+#pragma once
+// Frame-budget governor: when frames keep running over budget, trade a
+// little quality for time, one step at a time, and give it back once
+// there is headroom again.
+//
+// Each level includes the ones below it:
+//   1  NoHitFlash       skip hit-flash colour updates (TD enemies, invaders)
+//   2  SlowBackground   tick the off-screen scene half as often (SimLod)
+//   3  BatchedBullets   draw all bullets as one batch of quads
+//   4  SlowHud          refresh HUD text every kSlowHudInterval steps
+//
+// The render thread feeds it every frame. A level change reaches the sim
+// as a SimCommand (SetQuality), so it applies between steps and replays
+// see it at the same tick. Hit flash and HUD text don't touch sim state;
+// the background rate does, which is why it has to go through a command.
+//
+// Hysteresis: degrading needs kDegradeFrames frames in a row well over
+// budget; recovering needs kRecoverFrames frames in a row back on budget
+// with the busy time well under it. Anything in between holds the level,
+// and after any change the governor waits kSettleFrames before judging.
+
+#include <cstdint>
+
+class FrameGovernor {
+public:
+    enum Level : int {
+        Full = 0,
+        NoHitFlash,
+        SlowBackground,
+        BatchedBullets,
+        SlowHud,
+
+        kLevelCount
+    };
+    static constexpr int kMaxLevel = kLevelCount - 1;
+
+    static constexpr int   kDegradeFrames = 20;      // ~1/3 s over budget
+    static constexpr int   kRecoverFrames = 180;     // ~3 s of headroom
+    static constexpr int   kSettleFrames = 60;
+    static constexpr float kDegradeAt = 1.2f;        // frame avg vs budget
+    static constexpr float kRecoverFrameAt = 1.05f;  // frame avg vs budget
+    static constexpr float kRecoverBusyAt = 0.6f;    // busy avg vs budget
+
+    static constexpr int           kBackgroundSlowdown = 2;
+    static constexpr std::uint64_t kSlowHudInterval = 15;   // 4 Hz at 60 Hz
+
+    // Frame budget (ms); 0 keeps the level at Full
+    void  set_budget_ms(float ms) { _budgetMs = ms; }
+    float get_budget_ms() const { return _budgetMs; }
+
+    // One finished frame: display-to-display time, and how much of it was
+    // real work (render + sim steps) rather than waiting. Returns the
+    // level to use from now on.
+    int update(float frameMs, float busyMs);
+
+    // Back to Full with no history
+    void reset();
+
+    int get_level() const { return _level; }
+
+    // What each level turns off (any thread, any level value)
+    static bool hit_flash(int level) { return level < NoHitFlash; }
+    static int  background_slowdown(int level) {
+        return level >= SlowBackground ? kBackgroundSlowdown : 1;
+    }
+    static bool batch_bullets(int level) { return level >= BatchedBullets; }
+    static bool refresh_hud(int level, std::uint64_t tick) {
+        return level < SlowHud || tick % kSlowHudInterval == 0;
+    }
+
+    static const char* name(int level);
+
+private:
+    float _budgetMs = 0.f;
+    float _frameAvg = 0.f;   // moving averages (ms)
+    float _busyAvg = 0.f;
+    int   _level = Full;
+    int   _overFrames = 0;
+    int   _underFrames = 0;
+    int   _settle = 0;
+};
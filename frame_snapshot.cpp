@@ -0,0 +1,191 @@
+// frame_snapshot.cpp
+#include "frame_snapshot.hpp"
+#include "game_parameters.hpp"
+#include "tile_level_loader/level_system.hpp"
+
+#include <algorithm>
+
+using param = Parameters;
+
+// -------------------------
+// FrameSnapshot
+// -------------------------
+
+void FrameSnapshot::clear() {
+    background = sf::Color::Black;
+    level = nullptr;
+    hasCamera = false;
+    hasStats = false;
+    hasInput = false;
+    rects.clear();
+    circles.clear();
+    bullets.clear();
+    triangles.clear();
+    textCount = 0; // strings stay allocated for reuse
+}
+
+void FrameSnapshot::add_text(const std::string& text, const sf::Vector2f& pos,
+    unsigned int size, const sf::Color& color)
+{
+    add_text(text.c_str(), pos, size, color);
+}
+
+// Literals and formatted buffers go straight into a reused slot, without a
+// temporary std::string
+void FrameSnapshot::add_text(const char* text, const sf::Vector2f& pos,
+    unsigned int size, const sf::Color& color)
+{
+    if (textCount == texts.size()) {
+        texts.emplace_back();
+    }
+    SnapshotText& t = texts[textCount++];
+    t.text.assign(text);
+    t.pos = pos;
+    t.size = size;
+    t.color = color;
+}
+
+size_t FrameSnapshot::draw(sf::RenderWindow& window, const sf::Font& font, float alpha,
+    bool batchBullets) const
+{
+    // Shapes reused across frames (render thread only)
+    static sf::RectangleShape background;
+    static sf::RectangleShape rect;
+    static sf::CircleShape    circle;
+    static sf::ConvexShape    triangle(3);
+    static sf::Text           label;
+    static sf::VertexArray    bulletQuads(sf::Quads);
+
+    background.setSize({
+        static_cast<float>(param::game_width),
+        static_cast<float>(param::game_height)
+        });
+    background.setFillColor(this->background);
+    window.draw(background);
+
+    // World layers through the camera; the level only draws the chunks
+    // this view can see
+    const sf::View screen = window.getView();
+    window.setView(camera_view(screen, alpha));
+
+    // Tile grid (walls, path, etc.)
+    size_t drawCalls = 1;
+    if (level) {
+        drawCalls += level->render(window);
+    }
+
+    for (const auto& r : rects) {
+        rect.setPosition(r.pos);
+        rect.setSize(r.size);
+        rect.setFillColor(r.color);
+        window.draw(rect);
+    }
+
+    // Moving objects, interpolated between the last two sim states
+    for (const auto& c : circles) {
+        circle.setRadius(c.radius);
+        circle.setOrigin(c.radius, c.radius);
+        circle.setPosition(c.prevPos + (c.pos - c.prevPos) * alpha);
+        circle.setFillColor(c.color);
+        window.draw(circle);
+    }
+
+    size_t bulletCalls = 0;
+    if (batchBullets && !bullets.empty()) {
+        // One quad per bullet, one draw call; keeps its capacity
+        bulletQuads.clear();
+        for (const auto& b : bullets) {
+            const sf::Vector2f p = b.prevPos + (b.pos - b.prevPos) * alpha;
+            const float        r = b.radius;
+            bulletQuads.append(sf::Vertex({ p.x - r, p.y - r }, b.color));
+            bulletQuads.append(sf::Vertex({ p.x + r, p.y - r }, b.color));
+            bulletQuads.append(sf::Vertex({ p.x + r, p.y + r }, b.color));
+            bulletQuads.append(sf::Vertex({ p.x - r, p.y + r }, b.color));
+        }
+        window.draw(bulletQuads);
+        bulletCalls = 1;
+    }
+    else {
+        for (const auto& b : bullets) {
+            circle.setRadius(b.radius);
+            circle.setOrigin(b.radius, b.radius);
+            circle.setPosition(b.prevPos + (b.pos - b.prevPos) * alpha);
+            circle.setFillColor(b.color);
+            window.draw(circle);
+        }
+        bulletCalls = bullets.size();
+    }
+
+    for (const auto& t : triangles) {
+        triangle.setPoint(0, t.a);
+        triangle.setPoint(1, t.b);
+        triangle.setPoint(2, t.c);
+        triangle.setFillColor(t.color);
+        window.draw(triangle);
+    }
+
+    // HUD in window coordinates
+    window.setView(screen);
+    label.setFont(font);
+    for (size_t i = 0; i < textCount; ++i) {
+        const SnapshotText& t = texts[i];
+        label.setString(t.text);
+        label.setCharacterSize(t.size);
+        label.setFillColor(t.color);
+        label.setPosition(t.pos);
+        window.draw(label);
+    }
+
+    return drawCalls + rects.size() + circles.size() + bulletCalls + triangles.size() + textCount;
+}
+
+sf::View FrameSnapshot::camera_view(const sf::View& screen, float alpha) const {
+    sf::View view = screen;
+    if (!hasCamera) return view;
+
+    const sf::Vector2f size = screen.getSize();
+    const sf::Vector2f world = worldSize;
+    const sf::Vector2f target = cameraPrev + (camera - cameraPrev) * alpha;
+
+    sf::Vector2f center = screen.getCenter();
+    if (world.x > size.x) center.x = std::clamp(target.x, size.x * 0.5f, world.x - size.x * 0.5f);
+    if (world.y > size.y) center.y = std::clamp(target.y, size.y * 0.5f, world.y - size.y * 0.5f);
+    view.setCenter(center);
+    return view;
+}
+
+// -------------------------
+// SnapshotBuffer
+// -------------------------
+
+void SnapshotBuffer::publish() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // The renderer never saw the snapshot we're replacing: carry its
+        // input stamp forward (oldest wins) so slow frames still count
+        // towards input latency
+        if (_fresh) {
+            const FrameSnapshot& dropped = _buffers[_ready];
+            FrameSnapshot&       next = _buffers[_back];
+            if (dropped.hasInput && (!next.hasInput || dropped.inputIssued < next.inputIssued)) {
+                next.hasInput = true;
+                next.inputIssued = dropped.inputIssued;
+                next.inputHandled = dropped.inputHandled;
+            }
+        }
+        std::swap(_back, _ready);
+        _fresh = true;
+    }
+    _cv.notify_one();
+}
+
+bool SnapshotBuffer::acquire(std::chrono::microseconds timeout) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_cv.wait_for(lock, timeout, [this] { return _fresh; })) {
+        return false;
+    }
+    std::swap(_front, _ready);
+    _fresh = false;
+    return true;
+}
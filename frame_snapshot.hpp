@@ -0,0 +1,161 @@
+// frame_snapshot.hpp
+#pragma once
+// Immutable per-tick picture of what to draw, handed from the sim thread
+// to the render thread. Scenes fill one in publish(); the renderer only
+// ever reads the snapshot, never live scene state.
+
+#include <SFML/Graphics.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "frame_stats.hpp"
+
+class LevelSystem;
+
+// Moving circle: drawn between prevPos (start of the tick) and pos
+struct SnapshotCircle {
+    sf::Vector2f prevPos;
+    sf::Vector2f pos;
+    float        radius = 0.f;
+    sf::Color    color;
+};
+
+// Axis-aligned rectangle (turrets etc.), pos = top-left
+struct SnapshotRect {
+    sf::Vector2f pos;
+    sf::Vector2f size;
+    sf::Color    color;
+};
+
+// Flat triangle (melee attack arc)
+struct SnapshotTriangle {
+    sf::Vector2f a, b, c;
+    sf::Color    color;
+};
+
+// HUD text (drawn with the renderer's font)
+struct SnapshotText {
+    std::string  text;
+    sf::Vector2f pos;
+    unsigned int size = 24;
+    sf::Color    color = sf::Color::White;
+};
+
+struct FrameSnapshot {
+    // Sim tick this snapshot was taken after, and when it was published.
+    // The renderer uses publishTime + step to work out its interpolation alpha.
+    std::uint64_t                         tick = 0;
+    std::chrono::steady_clock::time_point publishTime;
+    float                                 step = 0.f;
+
+    // Layers, drawn in this order
+    sf::Color                     background = sf::Color::Black;
+    // Tile grid, if any. The one exception to "never live scene state":
+    // the grid is too big to copy every tick, so this points at the
+    // session's level. The renderer may only call its render(), which
+    // takes the level's lock; anything else it needs from the level is
+    // copied into a field here at publish (e.g. worldSize).
+    const LevelSystem*            level = nullptr;
+    std::vector<SnapshotRect>     rects;
+    std::vector<SnapshotCircle>   circles;
+    std::vector<SnapshotCircle>   bullets;      // small, many: can be batched
+    std::vector<SnapshotTriangle> triangles;
+
+    // Camera target for the world layers, interpolated like circles. On an
+    // axis where the world (level size in pixels, copied at publish) is
+    // bigger than the window the view follows it, kept inside the world;
+    // otherwise the view stays on the window. Texts are always drawn in
+    // window coordinates.
+    bool         hasCamera = false;
+    sf::Vector2f cameraPrev;
+    sf::Vector2f camera;
+    sf::Vector2f worldSize;
+
+    // Reset for a new tick. Keeps vector capacity (and text string
+    // capacity) so steady-state publishing doesn't allocate.
+    void clear();
+
+    void follow_camera(const sf::Vector2f& prevPos, const sf::Vector2f& pos,
+        const sf::Vector2f& world) {
+        hasCamera = true;
+        cameraPrev = prevPos;
+        camera = pos;
+        worldSize = world;
+    }
+    void add_rect(const sf::Vector2f& pos, const sf::Vector2f& size, const sf::Color& color) {
+        rects.push_back({ pos, size, color });
+    }
+    void add_circle(const sf::Vector2f& prevPos, const sf::Vector2f& pos,
+        float radius, const sf::Color& color) {
+        circles.push_back({ prevPos, pos, radius, color });
+    }
+    void add_bullet(const sf::Vector2f& prevPos, const sf::Vector2f& pos,
+        float radius, const sf::Color& color) {
+        bullets.push_back({ prevPos, pos, radius, color });
+    }
+    void add_triangle(const sf::Vector2f& a, const sf::Vector2f& b,
+        const sf::Vector2f& c, const sf::Color& color) {
+        triangles.push_back({ a, b, c, color });
+    }
+    void add_text(const std::string& text, const sf::Vector2f& pos,
+        unsigned int size = 24, const sf::Color& color = sf::Color::White);
+    void add_text(const char* text, const sf::Vector2f& pos,
+        unsigned int size = 24, const sf::Color& color = sf::Color::White);
+
+    // Texts in use this tick are [0, textCount); the rest are spare slots
+    std::vector<SnapshotText> texts;
+    size_t                    textCount = 0;
+
+    // Sim-side stats for the overlay (only filled while it's visible)
+    bool               hasStats = false;
+    FrameStats::Report stats;
+
+    // Oldest timed input edge this snapshot is the first to answer: when
+    // it was polled and when the sim step that handled it ran
+    bool                                  hasInput = false;
+    std::chrono::steady_clock::time_point inputIssued;
+    std::chrono::steady_clock::time_point inputHandled;
+
+    // Draw the whole snapshot. alpha blends circles between prevPos and pos.
+    // batchBullets draws every bullet as a square in a single draw call
+    // (FrameGovernor::BatchedBullets). Returns the number of draw calls made.
+    size_t draw(sf::RenderWindow& window, const sf::Font& font, float alpha,
+        bool batchBullets = false) const;
+
+    // View for the world layers at `alpha` (`screen` if there's no camera)
+    sf::View camera_view(const sf::View& screen, float alpha) const;
+};
+
+// Hands snapshots from the sim thread to the render thread without either
+// side waiting on the other's work: the sim fills back(), publish() swaps it
+// into the hand-off slot, and the renderer swaps the newest one into front().
+class SnapshotBuffer {
+public:
+    // Sim thread: buffer to fill for the next publish()
+    FrameSnapshot& back() { return _buffers[_back]; }
+
+    // Sim thread: make back() the newest snapshot. If the renderer hasn't
+    // taken the previous one, its input stamp moves into this one.
+    void publish();
+
+    // Render thread: wait up to `timeout` for a snapshot newer than front().
+    // Returns true if front() changed.
+    bool acquire(std::chrono::microseconds timeout);
+
+    // Render thread: newest snapshot acquired so far
+    const FrameSnapshot& front() const { return _buffers[_front]; }
+
+private:
+    FrameSnapshot           _buffers[3];
+    int                     _back = 0;
+    int                     _ready = 1;
+    int                     _front = 2;
+    bool                    _fresh = false;   // _ready holds an unseen snapshot
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+};
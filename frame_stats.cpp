@@ -0,0 +1,107 @@
+// frame_stats.cpp
+#include "frame_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+StatSummary RollingStat::summary() const {
+    StatSummary s;
+    s.samples = _count;
+    if (_count == 0) return s;
+
+    s.last = _samples[(_next + kWindow - 1) % kWindow];
+
+    // Window is small and fixed, so a stack copy + nth_element is cheap
+    std::array<float, kWindow> sorted;
+    std::copy(_samples.begin(), _samples.begin() + _count, sorted.begin());
+
+    float sum = 0.f;
+    s.min = sorted[0];
+    for (std::size_t i = 0; i < _count; ++i) {
+        sum += sorted[i];
+        s.min = std::min(s.min, sorted[i]);
+    }
+    s.avg = sum / static_cast<float>(_count);
+
+    // Nearest-rank 99th percentile
+    const std::size_t rank = (_count * 99 + 99) / 100 - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + _count);
+    s.p99 = sorted[rank];
+    return s;
+}
+
+float RollingStat::percentile(float pct) const {
+    if (_count == 0) return 0.f;
+
+    std::array<float, kWindow> sorted;
+    std::copy(_samples.begin(), _samples.begin() + _count, sorted.begin());
+
+    const float clamped = std::clamp(pct, 0.f, 100.f);
+    std::size_t rank = static_cast<std::size_t>(std::ceil(clamped / 100.f * static_cast<float>(_count)));
+    rank = (rank == 0) ? 0 : rank - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + _count);
+    return sorted[rank];
+}
+
+void FrameStats::report(Report& out) const {
+    for (std::size_t i = 0; i < kStatCount; ++i) {
+        const StatSummary s = _stats[i].summary();
+        if (s.samples > 0) out[i] = s;
+    }
+}
+
+const char* FrameStats::name(Stat stat) {
+    switch (stat) {
+    case Stat::Frame:              return "frame";
+    case Stat::Update:             return "update";
+    case Stat::Render:             return "render";
+    case Stat::InputLatency:       return "input->shown";
+    case Stat::InputQueue:         return " input->step";
+    case Stat::UpdateEnemies:      return " td enemies";
+    case Stat::UpdateTurrets:      return " td turrets";
+    case Stat::UpdateBullets:      return " td bullets";
+    case Stat::UpdateInvaders:     return " sh invaders";
+    case Stat::UpdateEnemyBullets: return " sh bullets";
+    case Stat::Entities:           return "entities";
+    case Stat::Bullets:            return "bullets";
+    case Stat::DrawCalls:          return "draw calls";
+    case Stat::Allocs:             return "sim allocs";
+    case Stat::FrameAllocs:        return "frame allocs";
+    case Stat::Quality:            return "degrade lvl";
+    case Stat::Count:              break;
+    }
+    return "?";
+}
+
+std::string FrameStats::format(const Report& report, float budgetMs) {
+    std::string text;
+    char line[96];
+
+    std::snprintf(line, sizeof(line), "%-13s %7s %7s %7s %7s\n",
+        "", "last", "avg", "p99", "min");
+    text += line;
+
+    for (std::size_t i = 0; i < kStatCount; ++i) {
+        const StatSummary& s = report[i];
+        if (s.samples == 0) continue;
+
+        const Stat stat = static_cast<Stat>(i);
+        if (is_time(stat)) {
+            // Frames hover around the budget by design; flag missed ones.
+            // An input waits for a poll, a step and a display at best.
+            float limit = budgetMs;
+            if (stat == Stat::Frame) limit = budgetMs * 1.5f;
+            else if (stat == Stat::InputLatency || stat == Stat::InputQueue) limit = budgetMs * 3.f;
+            std::snprintf(line, sizeof(line), "%-13s %7.2f %7.2f %7.2f %7.2f%s\n",
+                name(stat), s.last, s.avg, s.p99, s.min,
+                (s.p99 > limit) ? "  OVER" : "");
+        }
+        else {
+            std::snprintf(line, sizeof(line), "%-13s %7.0f %7.1f %7.0f %7.0f\n",
+                name(stat), s.last, s.avg, s.p99, s.min);
+        }
+        text += line;
+    }
+    return text;
+}
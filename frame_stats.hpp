@@ -0,0 +1,134 @@
+// frame_stats.hpp
+#pragma once
+// Always-on frame statistics: where each frame's time goes and how much
+// is alive. Every stat keeps a rolling window of its newest samples, so
+// recording is O(1) with no allocation; min/avg/p99 are only worked out
+// when someone asks (the F3 overlay, tools).
+//
+// Each stat must only be written by one thread at a time. The sim side
+// (update, phases, counts) lives in the GameSession; the render side
+// (frame, render, draw calls) in GameSystem.
+//
+// Allocation counts are only recorded in TILE_ENGINE_ALLOC_TRACKING builds
+// (see alloc_tracker.hpp).
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+enum class Stat {
+    // Times, in milliseconds
+    Frame,                // render loop, display to display
+    Update,               // one sim step
+    Render,               // drawing + display of one frame
+    InputLatency,         // input edge to the display() that first shows it
+    InputQueue,           //  of which: edge to the sim step that handles it
+    UpdateEnemies,        // TD phases
+    UpdateTurrets,
+    UpdateBullets,
+    UpdateInvaders,       // Safehouse phases
+    UpdateEnemyBullets,
+
+    // Counts per frame / step
+    Entities,             // everything alive in both scenes
+    Bullets,              // TD bullets + Safehouse enemy bullets
+    DrawCalls,
+    Allocs,               // heap allocations per sim step (incl. publish)
+    FrameAllocs,          // heap allocations per render frame
+    Quality,              // frame governor level (0 = full quality)
+
+    Count
+};
+
+// Newest sample plus min / avg / p99 over the window
+struct StatSummary {
+    float       last = 0.f;
+    float       min = 0.f;
+    float       avg = 0.f;
+    float       p99 = 0.f;
+    std::size_t samples = 0;
+};
+
+// Fixed ring of the newest kWindow samples
+class RollingStat {
+public:
+    static constexpr std::size_t kWindow = 240; // 4 s at 60 Hz
+
+    void add(float value) {
+        _samples[_next] = value;
+        _next = (_next + 1) % kWindow;
+        if (_count < kWindow) ++_count;
+    }
+
+    StatSummary summary() const;
+
+    // Nearest-rank percentile (0-100) over the window, 0 if no samples
+    float percentile(float pct) const;
+
+    // Newest sample (0 if none yet), without working out the summary
+    float last() const { return _count ? _samples[(_next + kWindow - 1) % kWindow] : 0.f; }
+
+private:
+    std::array<float, kWindow> _samples{};
+    std::size_t                _next = 0;
+    std::size_t                _count = 0;
+};
+
+class FrameStats {
+public:
+    static constexpr std::size_t kStatCount = static_cast<std::size_t>(Stat::Count);
+    using Report = std::array<StatSummary, kStatCount>;
+
+    void add(Stat stat, float value) {
+        _stats[index(stat)].add(value);
+        _step[index(stat)] += value;
+    }
+    StatSummary summary(Stat stat) const { return _stats[index(stat)].summary(); }
+    float       last(Stat stat) const { return _stats[index(stat)].last(); }
+    float       percentile(Stat stat, float pct) const { return _stats[index(stat)].percentile(pct); }
+
+    // Sum of what was added since the last clear_step(): 0 for a stat
+    // (say a phase) that got no samples this step, unlike last()
+    float step_total(Stat stat) const { return _step[index(stat)]; }
+    void  clear_step() { _step.fill(0.f); }
+
+    // Copy in the summary of every stat that has samples here; the rest of
+    // `out` is left alone, so sim and render reports can be merged
+    void report(Report& out) const;
+
+    static const char* name(Stat stat);
+    static bool        is_time(Stat stat) { return stat < Stat::Entities; }
+
+    // Overlay / log text, one line per stat with samples. Times whose p99
+    // is over budgetMs are flagged (frame time at 1.5x, i.e. a missed frame;
+    // input latency at 3x, i.e. more than poll + step + display).
+    static std::string format(const Report& report, float budgetMs);
+
+private:
+    static std::size_t index(Stat stat) { return static_cast<std::size_t>(stat); }
+
+    std::array<RollingStat, kStatCount> _stats;
+    std::array<float, kStatCount>       _step{};
+};
+
+// Records the time from construction to destruction into one stat
+class ScopedStatTimer {
+public:
+    ScopedStatTimer(FrameStats& stats, Stat stat)
+        : _stats(stats), _stat(stat), _start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedStatTimer() {
+        const std::chrono::duration<float, std::milli> ms =
+            std::chrono::steady_clock::now() - _start;
+        _stats.add(_stat, ms.count());
+    }
+
+    ScopedStatTimer(const ScopedStatTimer&) = delete;
+    ScopedStatTimer& operator=(const ScopedStatTimer&) = delete;
+
+private:
+    FrameStats&                           _stats;
+    Stat                                  _stat;
+    std::chrono::steady_clock::time_point _start;
+};
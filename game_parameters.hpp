@@ -10,6 +10,17 @@ struct Parameters {
     // Fixed timestep target (60 FPS)
     static constexpr float time_step = 1.0f / 60.0f;
 
+    // Off-screen scene simulation level-of-detail (see SimLod):
+    // tick every Nth step, never with a dt above background_max_dt,
+    // and go back to full rate for background_wake_time after an event
+    static constexpr int   background_tick_divisor = 2;
+    static constexpr float background_max_dt = 1.0f / 30.0f;
+    static constexpr float background_wake_time = 2.0f;
+
+    // A sim step or render frame longer than this (ms) dumps the flight
+    // recorder (see FlightRecorder); about three missed frames at 60 Hz
+    static constexpr float hitch_threshold_ms = 50.0f;
+
 	// Maze level files (will get rid of the maze_ prefix later)
     //static constexpr const char* maze_1 = "res/levels/maze_1.txt";
     //static constexpr const char* maze_2 = "res/levels/maze_2.txt";
@@ -0,0 +1,305 @@
+// game_session.cpp
+#include "game_session.hpp"
+#include "scenes.hpp"
+#include "trace.hpp"
+#include "alloc_tracker.hpp"
+#include "state_hash.hpp"
+#include "memory_report.hpp"
+#include "frame_governor.hpp"
+
+#include <algorithm>
+
+GameSession::GameSession()
+    : runContext(std::make_shared<RunContext>())
+{
+    safehouse = std::make_shared<SafehouseScene>(*this);
+    tower_defence = std::make_shared<TowerDefenceScene>(*this);
+    end = std::make_shared<EndScene>(*this);
+}
+
+GameSession::~GameSession() {
+    // Loader / background tick may still be touching the scenes
+    finish_prepare();
+    _backgroundSim.wait();
+}
+
+void GameSession::set_active_scene(const std::shared_ptr<Scene>& scene) {
+    // Copy first: `scene` may be one of the members reset below
+    const std::shared_ptr<Scene> next = scene;
+    if (next) {
+        if (next == _preparing) finish_prepare();
+        next->ensure_prepared();
+    }
+    _pending.reset();
+
+    // Swap scenes, calling unload/load around the change
+    if (_active_scene) _active_scene->unload();
+    _active_scene = next;
+    if (_active_scene) _active_scene->load();
+}
+
+void GameSession::request_scene(const std::shared_ptr<Scene>& scene) {
+    if (_replaying) {
+        // The recording says when the switch happened
+        prewarm(scene);
+        return;
+    }
+
+    if (!scene || scene->is_prepared()) {
+        record_scene_switch(scene);
+        set_active_scene(scene);
+        return;
+    }
+
+    // Keep ticking the current scene; update() switches once it's ready
+    prewarm(scene);
+    _pending = scene;
+}
+
+void GameSession::prewarm(const std::shared_ptr<Scene>& scene) {
+    if (!scene || scene->is_prepared() || scene == _preparing) return;
+
+    // One load at a time
+    finish_prepare();
+
+    _preparing = scene;
+    Scene* target = scene.get();
+    _prepareDone = std::async(std::launch::async, [target] {
+        Trace::set_thread_name("scene loader");
+        target->ensure_prepared();
+        });
+}
+
+void GameSession::finish_prepare() {
+    if (_prepareDone.valid()) _prepareDone.get();
+    _preparing.reset();
+}
+
+void GameSession::restart() {
+    finish_prepare();
+    _pending.reset();
+    _backgroundSim.wait();
+
+    // Fresh scenes; the level is reloaded when the new TD scene loads
+    safehouse = std::make_shared<SafehouseScene>(*this);
+    tower_defence = std::make_shared<TowerDefenceScene>(*this);
+    runContext = std::make_shared<RunContext>();
+
+    // Jump back to the start of the run (Safehouse) and get the new TD
+    // scene's level loading straight away
+    set_active_scene(safehouse);
+    prewarm(tower_defence);
+}
+
+void GameSession::clean() {
+    finish_prepare();
+    _pending.reset();
+    _backgroundSim.wait();
+    if (_active_scene) {
+        _active_scene->unload();
+        _active_scene.reset();
+    }
+}
+
+void GameSession::update(float dt) {
+    // Spans recorded from here on belong to this tick
+    Trace::set_frame(_tick);
+    ALLOC_SCOPE(Sim);
+
+    // A requested scene finished preparing: switch between steps
+    if (_pending && _pending->is_prepared()) {
+        record_scene_switch(_pending);
+        set_active_scene(_pending);
+    }
+
+    {
+        ScopedStatTimer timer(_stats, Stat::Update);
+        if (_active_scene) _active_scene->update(dt);
+    }
+    end_step();
+}
+
+void GameSession::end_step() {
+    size_t entities = 0;
+    size_t bullets = 0;
+    if (safehouse) safehouse->count_live(entities, bullets);
+    if (tower_defence) tower_defence->count_live(entities, bullets);
+
+    _stats.add(Stat::Entities, static_cast<float>(entities));
+    _stats.add(Stat::Bullets, static_cast<float>(bullets));
+
+    // Everything the sim allocated since the last step, publish included
+    std::uint64_t stepAllocs = 0;
+    if (AllocTracker::kEnabled) {
+        const std::uint64_t allocs = AllocTracker::sim_count();
+        stepAllocs = allocs - _simAllocs;
+        _stats.add(Stat::Allocs, static_cast<float>(stepAllocs));
+        _simAllocs = allocs;
+    }
+
+    FlightFrame frame;
+    frame.tick = _tick;
+    frame.updateMs = _stats.step_total(Stat::Update);
+    frame.enemiesMs = _stats.step_total(Stat::UpdateEnemies);
+    frame.turretsMs = _stats.step_total(Stat::UpdateTurrets);
+    frame.bulletsMs = _stats.step_total(Stat::UpdateBullets);
+    frame.invadersMs = _stats.step_total(Stat::UpdateInvaders);
+    frame.enemyBulletsMs = _stats.step_total(Stat::UpdateEnemyBullets);
+    frame.entities = static_cast<std::uint32_t>(entities);
+    frame.bullets = static_cast<std::uint32_t>(bullets);
+    frame.allocs = static_cast<std::uint32_t>(stepAllocs);
+    if (const auto* td = static_cast<const TowerDefenceScene*>(tower_defence.get())) {
+        frame.enemies = static_cast<std::uint32_t>(td->get_enemy_count());
+        frame.turrets = static_cast<std::uint32_t>(td->get_turret_count());
+        frame.level = td->getCurrentLevelIndex();
+        frame.wave = td->getCurrentWaveIndex();
+        frame.remainingPoints = td->getRemainingPoints();
+        frame.waitingForPlayer = td->isWaitingForPlayer();
+    }
+    if (const auto* sh = static_cast<const SafehouseScene*>(safehouse.get())) {
+        frame.invaders = static_cast<std::uint32_t>(sh->get_invader_count());
+    }
+    _flight.record(frame);
+
+    if (_trackMemory) record_memory();
+
+    // Phases that don't run next step must read 0 there, not this step's time
+    _stats.clear_step();
+    ++_tick;
+}
+
+void GameSession::handle_command(const SimCommand& cmd) {
+    if (_recording) {
+        ReplayEvent event;
+        event.tick = _tick;
+        event.command = cmd;
+        _replay.events.push_back(event);
+    }
+
+    // Latency is measured from the oldest edge a snapshot answers
+    if (cmd.issued != std::chrono::steady_clock::time_point{} &&
+        (!_hasInput || cmd.issued < _inputIssued)) {
+        _inputIssued = cmd.issued;
+        _inputHandled = std::chrono::steady_clock::now();
+        _hasInput = true;
+    }
+
+    if (cmd.type == SimCommandType::InputState) {
+        _input.feed(cmd.input);
+    }
+    else if (cmd.type == SimCommandType::SetQuality) {
+        _quality = std::clamp(cmd.value, 0, static_cast<int>(FrameGovernor::kMaxLevel));
+        _backgroundLod.set_slowdown(FrameGovernor::background_slowdown(_quality));
+    }
+    else if (_active_scene) {
+        _active_scene->handle_command(cmd);
+    }
+}
+
+bool GameSession::take_input_stamp(std::chrono::steady_clock::time_point& issued,
+    std::chrono::steady_clock::time_point& handled) {
+    if (!_hasInput) return false;
+    issued = _inputIssued;
+    handled = _inputHandled;
+    _hasInput = false;
+    return true;
+}
+
+// -------------------------
+// Memory footprint
+// -------------------------
+
+void GameSession::set_memory_tracking(bool on) {
+    _trackMemory = on;
+    if (on && _waveMemory.empty()) {
+        _waveMemory.resize(WaveManager::kTotalLevels * WaveManager::kWavesPerLevel);
+    }
+}
+
+void GameSession::report_memory(MemoryReport& out) const {
+    _level.report_memory(out);
+    if (safehouse) safehouse->report_memory(out);
+    if (tower_defence) tower_defence->report_memory(out);
+    if (end) end->report_memory(out);
+}
+
+void GameSession::record_memory() {
+    _memory.clear();
+    report_memory(_memory);
+    _memoryPeak.keep_max(_memory);
+
+    // Charged to the wave that's running, or next up while TD waits
+    const auto* td = static_cast<const TowerDefenceScene*>(tower_defence.get());
+    if (!td || td->hasFinishedAllWaves()) return;
+    const size_t wave = static_cast<size_t>(
+        td->getCurrentLevelIndex() * WaveManager::kWavesPerLevel + td->getCurrentWaveIndex());
+    if (wave < _waveMemory.size()) _waveMemory[wave].keep_max(_memory);
+}
+
+std::uint64_t GameSession::state_hash() const {
+    StateHash h;
+    h.add(scene_index(_active_scene));
+    if (safehouse) safehouse->hash_state(h);
+    if (tower_defence) tower_defence->hash_state(h);
+    if (runContext) {
+        h.add(runContext->waveNumber);
+        h.add(runContext->currency);
+        h.add(runContext->runOver);
+    }
+    return h.value();
+}
+
+void GameSession::publish(FrameSnapshot& out) const {
+    if (_active_scene) _active_scene->publish(out);
+}
+
+// -------------------------
+// Recording / playback
+// -------------------------
+
+void GameSession::start_recording(float step) {
+    _replay.clear();
+    _replay.seed = _seed;
+    _replay.step = step;
+    _recording = true;
+}
+
+bool GameSession::save_recording(const std::string& path) {
+    _replay.ticks = _tick;
+    return _replay.save(path);
+}
+
+void GameSession::record_scene_switch(const std::shared_ptr<Scene>& scene) {
+    if (!_recording) return;
+
+    ReplayEvent event;
+    event.tick = _tick;
+    event.kind = ReplayEvent::Kind::SceneSwitch;
+    event.scene = scene_index(scene);
+    _replay.events.push_back(event);
+}
+
+void GameSession::apply_replay_event(const ReplayEvent& event) {
+    if (event.kind == ReplayEvent::Kind::SceneSwitch) {
+        set_active_scene(scene_at(event.scene));
+    }
+    else {
+        handle_command(event.command);
+    }
+}
+
+int GameSession::scene_index(const std::shared_ptr<Scene>& scene) const {
+    if (scene == safehouse) return 0;
+    if (scene == tower_defence) return 1;
+    if (scene == end) return 2;
+    return -1;
+}
+
+std::shared_ptr<Scene> GameSession::scene_at(int index) const {
+    switch (index) {
+    case 0: return safehouse;
+    case 1: return tower_defence;
+    case 2: return end;
+    default: return nullptr;
+    }
+}
@@ -0,0 +1,220 @@
+// game_session.hpp
+#pragma once
+// One independent run of the game: its level, scenes, run data, sim-side
+// input and the background worker for the off-screen scene.
+//
+// Nothing in here is static, so a process can host as many sessions as it
+// likes. The windowed game drives one through GameSystem; the headless
+// runner can tick many at once on a thread pool. Each session must only
+// be stepped by one thread at a time.
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flight_recorder.hpp"
+#include "frame_stats.hpp"
+#include "input.hpp"
+#include "memory_report.hpp"
+#include "replay.hpp"
+#include "run_context.hpp"
+#include "sim_command.hpp"
+#include "sim_lod.hpp"
+#include "sim_worker.hpp"
+#include "WaveGeneration.hpp"
+#include "tile_level_loader/level_system.hpp"
+
+class JobSystem;
+class Scene;
+struct FrameSnapshot;
+
+class GameSession {
+public:
+    // Creates the run context and the Safehouse, Tower Defence and End
+    // scenes. No scene is active until set_active_scene() is called.
+    GameSession();
+    ~GameSession();
+
+    GameSession(const GameSession&) = delete;
+    GameSession& operator=(const GameSession&) = delete;
+
+    // Scene handles for this run
+    std::shared_ptr<Scene> safehouse;
+    std::shared_ptr<Scene> tower_defence;
+    std::shared_ptr<Scene> end;
+
+    // Shared run data (wave number, currency, player stats, etc.)
+    std::shared_ptr<RunContext> runContext;
+
+    // Change which scene is active right now (calls unload/load). Prepares
+    // the scene first if that hasn't happened yet, which may be slow.
+    void set_active_scene(const std::shared_ptr<Scene>& scene);
+
+    // Switch to `scene` without a hitch: it is prepared on the loader thread
+    // while the current scene keeps ticking, and the switch happens at the
+    // start of the first step after it is ready. Immediate if already ready.
+    void request_scene(const std::shared_ptr<Scene>& scene);
+
+    // Start preparing `scene` on the loader thread ahead of time
+    void prewarm(const std::shared_ptr<Scene>& scene);
+
+    // Scene waiting for its prepare() before becoming active (if any)
+    const std::shared_ptr<Scene>& get_pending_scene() const { return _pending; }
+    const std::shared_ptr<Scene>& get_active_scene() const { return _active_scene; }
+
+    // Recreate Safehouse + TD from scratch and go back to the Safehouse
+    void restart();
+
+    // Unload and forget the active scene
+    void clean();
+
+    // One fixed step of the active scene
+    void update(float dt);
+
+    // Player command: held-key state and the quality level are kept here,
+    // the rest goes to the active scene
+    void handle_command(const SimCommand& cmd);
+
+    // Describe the active scene for the renderer
+    void publish(FrameSnapshot& out) const;
+
+    // Input latency: the oldest timed input edge handled since the last
+    // call (`issued`) and when its step ran (`handled`). Returns false if
+    // none; either way the next call starts afresh.
+    bool take_input_stamp(std::chrono::steady_clock::time_point& issued,
+        std::chrono::steady_clock::time_point& handled);
+
+    // Per-run systems used by the scenes
+    LevelSystem&       level() { return _level; }
+    const LevelSystem& level() const { return _level; }
+    const Input&       input() const { return _input; }
+    SimWorker&         background_sim() { return _backgroundSim; }
+    SimLod&            background_lod() { return _backgroundLod; }
+
+    // Optional scheduler for splitting big sim phases across cores
+    // (not owned; nullptr runs every phase on the ticking thread)
+    void       set_job_system(JobSystem* jobs) { _jobs = jobs; }
+    JobSystem* get_job_system() const { return _jobs; }
+
+    // Steps run so far
+    std::uint64_t get_tick() const { return _tick; }
+
+    // Frame governor level the scenes degrade to (see frame_governor.hpp).
+    // Set through a SetQuality command so recordings keep it in step.
+    int get_quality() const { return _quality; }
+
+    // Checksum of the simulation state (both game scenes, run data) as of
+    // now, for comparing runs bit-for-bit. Walks every entity, so only
+    // call it when checking.
+    std::uint64_t state_hash() const;
+
+    // Seed for the run's random choices (wave enemy picks). Used when TD
+    // first loads, so set it before then.
+    void         set_seed(unsigned int seed) { _seed = seed; }
+    unsigned int get_seed() const { return _seed; }
+
+    // Record every command handled and every scene switch from here on,
+    // tagged with the tick it applied to. `step` is the fixed step the
+    // session is being run at.
+    void start_recording(float step);
+    bool is_recording() const { return _recording; }
+
+    // Write what was recorded so far (see replay.hpp)
+    bool save_recording(const std::string& path);
+
+    // Playback: scene switches only happen through replayed SceneSwitch
+    // events, never on loader-thread timing. Set before the first step.
+    void set_replaying(bool replaying) { _replaying = replaying; }
+
+    // Apply one recorded event (call for each event due before update())
+    void apply_replay_event(const ReplayEvent& event);
+
+    // 0 safehouse, 1 tower defence, 2 end, -1 anything else
+    int                    scene_index(const std::shared_ptr<Scene>& scene) const;
+    std::shared_ptr<Scene> scene_at(int index) const;
+
+    // Sim-side stats: step time, per-phase times, live counts
+    FrameStats&       get_stats() { return _stats; }
+    const FrameStats& get_stats() const { return _stats; }
+
+    // Bookkeeping after each step of the scenes: live entity / bullet
+    // counts (both game scenes), in alloc tracking builds the sim's
+    // allocations since the last call (process-wide, so only meaningful
+    // with one session running), the flight recorder frame, the memory
+    // footprint when tracked, and the tick counter. update() calls it; tools that tick scenes directly call it
+    // once per step instead.
+    void end_step();
+
+    // Last few seconds of steps, dumped on a hitch (see flight_recorder.hpp)
+    FlightRecorder&       flight_recorder() { return _flight; }
+    const FlightRecorder& flight_recorder() const { return _flight; }
+
+    // Memory footprint per subsystem (see memory_report.hpp). Off by
+    // default; when on, end_step() measures after every step and keeps
+    // the run's high-water mark and each TD wave's (the wave running, or
+    // next up while TD waits for the player).
+    void set_memory_tracking(bool on);
+    bool is_memory_tracking() const { return _trackMemory; }
+
+    // Measure now: level, both game scenes and their HUD text (sim thread)
+    void report_memory(MemoryReport& out) const;
+
+    // Footprint after the newest step, and high-water marks. Wave peaks
+    // are indexed level * WaveManager::kWavesPerLevel + wave (0-based);
+    // waves not reached yet are all zero.
+    const MemoryReport&              get_memory() const { return _memory; }
+    const MemoryReport&              get_memory_peak() const { return _memoryPeak; }
+    const std::vector<MemoryReport>& get_wave_memory_peaks() const { return _waveMemory; }
+
+private:
+    LevelSystem _level;
+
+    // Held keys as last forwarded by the input thread
+    Input _input;
+
+    // Ticks whichever scene is off screen, on its reduced-rate schedule.
+    // Declared after the scene handles so it is joined before they go.
+    SimWorker _backgroundSim;
+    SimLod    _backgroundLod;
+
+    JobSystem* _jobs = nullptr;
+
+    FrameStats     _stats;
+    std::uint64_t  _simAllocs = 0;   // AllocTracker::sim_count() at the last record
+    FlightRecorder _flight;
+
+    bool                      _trackMemory = false;
+    MemoryReport              _memory;
+    MemoryReport              _memoryPeak;
+    std::vector<MemoryReport> _waveMemory;   // sized when tracking starts
+
+    void record_memory();
+
+    std::shared_ptr<Scene> _active_scene;
+    std::uint64_t          _tick = 0;
+    int                    _quality = 0;
+
+    bool                                  _hasInput = false;
+    std::chrono::steady_clock::time_point _inputIssued;
+    std::chrono::steady_clock::time_point _inputHandled;
+
+    unsigned int _seed = WaveManager::kDefaultSeed;
+
+    Replay _replay;
+    bool   _recording = false;
+    bool   _replaying = false;
+
+    void record_scene_switch(const std::shared_ptr<Scene>& scene);
+
+    // Scene being prepared on the loader thread, and the one to switch to
+    // once it's ready
+    std::shared_ptr<Scene> _preparing;
+    std::future<void>      _prepareDone;
+    std::shared_ptr<Scene> _pending;
+
+    // Block until the in-flight prepare (if any) has finished
+    void finish_prepare();
+};
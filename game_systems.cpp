@@ -3,15 +3,46 @@
 
 #include "game_systems.hpp"
 #include "entity.hpp" // needed for update/render calls
+#include "game_session.hpp"
+#include "trace.hpp"
+#include "alloc_tracker.hpp"
+#include "state_hash.hpp"
 
 #include <SFML/Graphics.hpp>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
 // -------------------------
 // Static storage
 // -------------------------
-std::shared_ptr<Scene> GameSystem::_active_scene = nullptr;
+std::shared_ptr<GameSession> GameSystem::_session = nullptr;
 // Single global window owned by GameSystem
 std::unique_ptr<sf::RenderWindow> GameSystem::_window = nullptr;
+// Sim -> render snapshots and render -> sim commands
+SnapshotBuffer GameSystem::_snapshots;
+SpscQueue<SimCommand, 64> GameSystem::_commands;
+std::atomic<bool> GameSystem::_running{ false };
+// Main-thread input
+Input GameSystem::_input;
+InputFrame::Bits GameSystem::_last_held;
+// Render-side stats and the F3 overlay toggle
+FrameStats GameSystem::_render_stats;
+std::atomic<bool> GameSystem::_show_stats{ false };
+MemoryReport GameSystem::_render_memory;
+// Turbo / time-scale state
+std::atomic<int> GameSystem::_time_scale{ 1 };
+std::atomic<int> GameSystem::_substeps_last{ 0 };
+std::atomic<int> GameSystem::_substeps_sustainable{ 0 };
+std::atomic<float> GameSystem::_step_cost_ms{ 0.f };
+FrameGovernor GameSystem::_governor;
+bool GameSystem::_governor_enabled = true;
+int GameSystem::_quality_sent = 0;
 
 // -------------------------
 // Scene implementation
@@ -20,22 +51,47 @@ std::unique_ptr<sf::RenderWindow> GameSystem::_window = nullptr;
 void Scene::update(const float& dt) {
     // Update all entities in this scene
     for (auto& ent : _entities) {
-        if (ent) ent->update(dt);
+        if (!ent) continue;
+        ent->store_previous_position(); // remember where we were for interpolation
+        ent->update(dt);
     }
 }
 
-void Scene::render(sf::RenderWindow& window) {
-    // Draw all entities in this scene
+void Scene::publish(FrameSnapshot& out) const {
+    // Describe all entities in this scene
     for (auto& ent : _entities) {
-        if (ent) ent->render(window);
+        if (ent) ent->publish(out);
     }
 }
 
+void Scene::handle_command(const SimCommand& /*cmd*/) {
+    // Base scene ignores player commands
+}
+
+void Scene::count_live(size_t& entities, size_t& /*bullets*/) const {
+    entities += _entities.size();
+}
+
+void Scene::hash_state(StateHash& h) const {
+    h.add(static_cast<std::uint64_t>(_entities.size()));
+    for (const auto& e : _entities) {
+        h.add(e->get_position());
+    }
+}
+
+void Scene::report_memory(MemoryReport& /*out*/) const {}
+
 void Scene::unload() {
     // Default behaviour: clear all entities
     _entities.clear();
 }
 
+void Scene::ensure_prepared() {
+    if (_prepared.load(std::memory_order_acquire)) return;
+    prepare();
+    _prepared.store(true, std::memory_order_release);
+}
+
 // -------------------------
 // GameSystem implementation
 // -------------------------
@@ -53,84 +109,484 @@ void GameSystem::start(unsigned int width,
     sf::RenderWindow& window = *_window;
     window.setFramerateLimit(0); // we control pacing manually
 
+    sf::Font font;
+    if (!font.loadFromFile("res/fonts/ARIAL.TTF")) {
+        std::cerr << "Failed to load font: res/fonts/ARIAL.TTF\n";
+    }
+
     _init();
+    Trace::set_thread_name("main (render)");
+    AllocTracker::set_current(AllocScope::Render);
+
+    // Simulation runs on its own thread from here on
+    _running = true;
+    std::thread simThread(&GameSystem::_sim_loop, time_step);
 
     sf::Event event{};
-    sf::Clock clock;
 
-    // Core game loop
-    while (window.isOpen()) {
-        // Handle OS / window events
+    // Stats overlay, drawn over the snapshot when F3 is on
+    sf::Text statsText;
+    statsText.setFont(font);
+    statsText.setCharacterSize(13);
+    statsText.setPosition(430.f, 10.f);
+    sf::RectangleShape statsBackground({ 360.f, 310.f });
+    statsBackground.setPosition(425.f, 5.f);
+    statsBackground.setFillColor(sf::Color(0, 0, 0, 170));
+    FrameStats::Report statsReport;
+    sf::Clock frameClock;
+    std::uint64_t frameAllocs = 0;
+
+    // Quality governor judges frames against the fixed step (off for
+    // variable-step loops)
+    _governor.reset();
+    _governor.set_budget_ms(time_step * 1000.f);
+    _quality_sent = FrameGovernor::Full;
+
+    // Character sizes drawn so far: the font has a glyph page for each
+    const bool trackMemory = _session && _session->is_memory_tracking();
+    std::array<bool, 128> fontSizes{};
+
+    // How long to wait for a new snapshot before polling events again
+    const auto snapshotWait = std::chrono::microseconds(
+        time_step > 0.0f ? static_cast<long long>(time_step * 2e6f) : 16000);
+
+    // Render / input loop (main thread)
+    while (window.isOpen() && _running) {
+        // Handle OS / window events; input is built from the same events
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
                 window.close();
-                clean();
-                return;
             }
+            _input.handle_event(event);
         }
+        if (!window.isOpen()) break;
+        _input.end_frame(window);
+        const auto polled = std::chrono::steady_clock::now();
 
         // Quick exit during development
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape)) {
+        if (_input.held(sf::Keyboard::Escape)) {
             window.close();
             break;
         }
 
-        // Time since last frame
-        const float dt = clock.restart().asSeconds();
+        // Turn this frame's key presses into sim commands
+        _post_input(polled);
+
+        // Draw the newest snapshot; if the sim hasn't produced one yet we
+        // just go round again and keep the window responsive
+        if (!_snapshots.acquire(snapshotWait)) continue;
+        const FrameSnapshot& snap = _snapshots.front();
+
+        // How far we are between the snapshot's previous and current state
+        float alpha = 1.0f;
+        if (snap.step > 0.0f) {
+            const float since = std::chrono::duration<float>(
+                std::chrono::steady_clock::now() - snap.publishTime).count();
+            alpha = std::min(since / snap.step, 1.0f);
+        }
 
+        TRACE_SCOPE("GameSystem::_render");
+        const ScopedStatTimer renderTimer(_render_stats, Stat::Render);
         window.clear();
-        _update(dt);
-        _render(window);
+        const int quality = _governor.get_level();
+        size_t drawCalls = snap.draw(window, font, alpha, FrameGovernor::batch_bullets(quality));
 
-        // Optional fixed pacing (acts like a manual vsync)
-        if (time_step > 0.0f) {
-            sf::sleep(sf::seconds(time_step));
+        if (_show_stats && snap.hasStats) {
+            // Sim side from the snapshot, render side from here
+            statsReport = snap.stats;
+            _render_stats.report(statsReport);
+            statsText.setString(FrameStats::format(statsReport, time_step * 1000.f));
+            window.draw(statsBackground);
+            window.draw(statsText);
+            drawCalls += 2;
+            fontSizes[statsText.getCharacterSize()] = true;
+        }
+        if (trackMemory) {
+            for (size_t i = 0; i < snap.textCount; ++i) {
+                const unsigned int size = snap.texts[i].size;
+                if (size < fontSizes.size()) fontSizes[size] = true;
+            }
         }
+
         window.display();
+        if (snap.hasInput) {
+            // First time this input's result is on screen
+            const std::chrono::duration<float, std::milli> shown =
+                std::chrono::steady_clock::now() - snap.inputIssued;
+            const std::chrono::duration<float, std::milli> queued =
+                snap.inputHandled - snap.inputIssued;
+            _render_stats.add(Stat::InputLatency, shown.count());
+            _render_stats.add(Stat::InputQueue, queued.count());
+        }
+        _render_stats.add(Stat::DrawCalls, static_cast<float>(drawCalls));
+        const float frameMs = frameClock.restart().asSeconds() * 1000.f;
+        _render_stats.add(Stat::Frame, frameMs);
+        _render_stats.add(Stat::Quality, static_cast<float>(quality));
+        _govern(frameMs);
+        if (_session) _session->flight_recorder().note_frame_time(frameMs);
+        if (AllocTracker::kEnabled) {
+            const std::uint64_t allocs = AllocTracker::count(AllocScope::Render);
+            _render_stats.add(Stat::FrameAllocs, static_cast<float>(allocs - frameAllocs));
+            frameAllocs = allocs;
+        }
+    }
+
+    _running = false;
+    simThread.join();
+
+    // Responsiveness over the last inputs, for tuning the loop against
+    const StatSummary latency = _render_stats.summary(Stat::InputLatency);
+    if (latency.samples > 0) {
+        char line[192];
+        std::snprintf(line, sizeof(line), "Input to display over the last %zu inputs: "
+            "p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms (to sim step: p50 %.1f ms, p99 %.1f ms)",
+            latency.samples,
+            _render_stats.percentile(Stat::InputLatency, 50.f),
+            _render_stats.percentile(Stat::InputLatency, 90.f),
+            _render_stats.percentile(Stat::InputLatency, 99.f),
+            _render_stats.percentile(Stat::InputLatency, 100.f),
+            _render_stats.percentile(Stat::InputQueue, 50.f),
+            _render_stats.percentile(Stat::InputQueue, 99.f));
+        std::cout << "[GameSystem] " << line << "\n";
+    }
+
+    if (trackMemory) {
+        // Glyph pages are RGBA textures (GPU side, but they grow with
+        // every size and glyph drawn)
+        _render_memory.clear();
+        for (unsigned int size = 0; size < fontSizes.size(); ++size) {
+            if (!fontSizes[size]) continue;
+            const sf::Vector2u page = font.getTexture(size).getSize();
+            _render_memory.add(MemPool::Fonts, static_cast<size_t>(page.x) * page.y * 4, 1);
+        }
+
+        // Overlay text, and the text slots of the snapshot on screen
+        // (the other two buffers hold about the same)
+        _render_memory.add(MemPool::HudText, MemSize::text(statsText));
+        const FrameSnapshot& snap = _snapshots.front();
+        _render_memory.add_vector(MemPool::HudText, snap.texts);
+        for (const auto& t : snap.texts) _render_memory.add(MemPool::HudText, MemSize::string(t.text));
     }
 
     window.close();
     clean();
 }
 
-sf::RenderWindow& GameSystem::get_window() {
-    // Accessor for the global window (used e.g. for mouse coords)
-    return *_window;
+void GameSystem::_sim_loop(float time_step) {
+    Trace::set_thread_name("sim");
+
+    sf::Clock clock;
+    sf::Clock stepClock;
+
+    // Unsimulated time carried between loops. The sim only ever advances in
+    // whole time_step chunks; whatever is left over is the render alpha.
+    float accumulator = 0.0f;
+
+    // Running average of the real cost of one step (seconds)
+    float avgStepCost = 0.0f;
+
+    while (_running) {
+        // Time since last loop (clamped so a long stall doesn't make us
+        // try to catch up forever - the "spiral of death")
+        float frameTime = clock.restart().asSeconds();
+        if (frameTime > kMaxFrameTime) frameTime = kMaxFrameTime;
+
+        if (time_step <= 0.0f) {
+            // Variable step: one update per loop with the measured dt
+            _apply_commands();
+            _update(frameTime);
+            _publish(0.0f);
+            continue;
+        }
+
+        // Time scale never changes the step size, only how many fixed
+        // steps we run per loop, so bullets and spawn timers behave the
+        // same at 8x as at 1x.
+        const int scale = _time_scale;
+
+        // Real time stepping may take per loop. At 1x we allow catching up
+        // on a stall; sped up we give up on the backlog once a frame's worth
+        // of time is spent, and the game just runs slower than requested.
+        const float budget = (scale == 1) ? kMaxFrameTime : time_step * kStepBudget;
+
+        int substeps = 0;
+        stepClock.restart();
+
+        if (scale == kTimeScaleMax) {
+            // As many steps as fit in the budget, every loop
+            do {
+                _apply_commands();
+                _update(time_step);
+                ++substeps;
+            } while (stepClock.getElapsedTime().asSeconds() < budget);
+            accumulator = 0.0f;
+        }
+        else {
+            // Run as many whole steps as the (scaled) elapsed time allows
+            accumulator += frameTime * static_cast<float>(scale);
+            while (accumulator >= time_step) {
+                _apply_commands();
+                _update(time_step);
+                accumulator -= time_step;
+                ++substeps;
+
+                if (stepClock.getElapsedTime().asSeconds() >= budget) {
+                    // Can't keep up: drop the whole-step backlog
+                    accumulator = std::fmod(accumulator, time_step);
+                    break;
+                }
+            }
+        }
+
+        if (substeps > 0) {
+            // Track what this machine can sustain at the current load
+            const float stepCost = stepClock.getElapsedTime().asSeconds() / substeps;
+            avgStepCost = (avgStepCost <= 0.0f) ? stepCost
+                : avgStepCost + (stepCost - avgStepCost) * 0.1f;
+
+            _substeps_last = substeps;
+            _step_cost_ms = avgStepCost * 1000.0f;
+            _substeps_sustainable = (avgStepCost > 0.0f)
+                ? static_cast<int>((time_step * kStepBudget) / avgStepCost)
+                : 0;
+
+            _publish(time_step);
+        }
+
+        // Sleep only until the next sim step is due, minus the time we
+        // already spent on this loop's work (never in max mode)
+        if (scale != kTimeScaleMax) {
+            const float untilNextStep =
+                (time_step - accumulator) / static_cast<float>(scale) -
+                clock.getElapsedTime().asSeconds();
+            if (untilNextStep > 0.0f) {
+                sf::sleep(sf::seconds(untilNextStep));
+            }
+        }
+    }
 }
 
-void GameSystem::clean() {
-    // Unload and forget current scene
-    if (_active_scene) {
-        _active_scene->unload();
-        _active_scene.reset();
+void GameSystem::_apply_commands() {
+    // Hand queued player commands to the session (input state or the
+    // scene that is active right now)
+    SimCommand cmd;
+    while (_commands.pop(cmd)) {
+        if (_session) _session->handle_command(cmd);
+    }
+}
+
+void GameSystem::_publish(float time_step) {
+    TRACE_SCOPE("GameSystem::_publish");
+    ALLOC_SCOPE(Publish);
+    FrameSnapshot& snap = _snapshots.back();
+    snap.clear();
+    if (_session) {
+        _session->publish(snap);
+        snap.hasInput = _session->take_input_stamp(snap.inputIssued, snap.inputHandled);
+    }
+
+    // Sim-side stats for the overlay, only worked out while it's visible
+    if (_show_stats && _session) {
+        _session->get_stats().report(snap.stats);
+        snap.hasStats = true;
     }
+
+    // Sped-up indicator + how many steps per frame we could sustain
+    const int scale = _time_scale;
+    if (scale != 1) {
+        // Formatted in place: the snapshot text keeps its capacity
+        char speed[96];
+        if (scale == kTimeScaleMax) {
+            std::snprintf(speed, sizeof(speed), "Speed MAX  |  %d steps/frame  |  ~%d sustainable",
+                _substeps_last.load(), _substeps_sustainable.load());
+        }
+        else {
+            std::snprintf(speed, sizeof(speed), "Speed x%d  |  %d steps/frame  |  ~%d sustainable",
+                scale, _substeps_last.load(), _substeps_sustainable.load());
+        }
+        snap.add_text(speed, { 20.f, 560.f }, 18, sf::Color::Yellow);
+    }
+
+    snap.tick = _session ? _session->get_tick() : 0;
+    snap.step = time_step;
+    snap.publishTime = std::chrono::steady_clock::now();
+    _snapshots.publish();
 }
 
-void GameSystem::reset() {
-    // Reload the current scene from scratch
-    if (_active_scene) {
-        _active_scene->unload();
-        _active_scene->load();
+void GameSystem::_post_input(std::chrono::steady_clock::time_point polled) {
+    const Input& in = _input;
+
+    // Every command stamped with the poll time, for the latency stats
+    auto post = [polled](SimCommand cmd) {
+        cmd.issued = polled;
+        return post_command(cmd);
+    };
+
+    // Forward held keys to the sim whenever they change (movement etc.)
+    if (in.frame().held != _last_held) {
+        SimCommand cmd{ SimCommandType::InputState };
+        cmd.input = in.frame();
+        if (post(cmd)) {
+            _last_held = in.frame().held; // retry next frame if the queue was full
+        }
+    }
+
+    if (in.pressed(sf::Keyboard::LShift) || in.pressed(sf::Keyboard::RShift)) {
+        post({ SimCommandType::SwapScene });
+    }
+    if (in.pressed(sf::Keyboard::E)) {
+        post({ SimCommandType::StartWave });
+    }
+    if (in.pressed(sf::Keyboard::F)) {
+        post({ SimCommandType::PlaceTurret });
+    }
+    if (in.pressed(sf::Keyboard::R)) {
+        post({ SimCommandType::Restart });
+    }
+    if (in.pressed(sf::Keyboard::F3)) {
+        // Stats overlay is drawn by this thread; no sim command needed
+        set_stats_overlay(!_show_stats);
+    }
+    if (in.pressed(sf::Keyboard::F4)) {
+        // Dump the newest trace spans of every thread for a trace viewer,
+        // and have the sim dump its flight recorder after the next step
+        Trace::write_chrome_json("trace.json");
+        if (_session) _session->flight_recorder().request_dump();
+    }
+    if (in.pressed(sf::Keyboard::T)) {
+        // Time scale is a loop setting, not a scene command
+        cycle_time_scale();
+    }
+    if (in.pressed(sf::Keyboard::Space)) {
+        // Melee aims at the mouse, in world coords
+        SimCommand cmd{ SimCommandType::MeleeAttack };
+        cmd.aim = in.mouse_world();
+        post(cmd);
+    }
+
+    // Debug / testing: spawn specific invader types with number keys
+    for (int i = 0; i < 9; ++i) {
+        const auto key = static_cast<sf::Keyboard::Key>(sf::Keyboard::Num1 + i);
+        if (in.pressed(key)) {
+            SimCommand cmd{ SimCommandType::SpawnTestEnemy };
+            cmd.value = i; // Num1 = EnemyType::Basic, ...
+            post(cmd);
+        }
     }
 }
 
-void GameSystem::set_active_scene(const std::shared_ptr<Scene>& act_sc) {
-    // Swap scenes, calling unload/load around the change
-    if (_active_scene) _active_scene->unload();
-    _active_scene = act_sc;
-    if (_active_scene) _active_scene->load();
+bool GameSystem::post_command(const SimCommand& cmd) {
+    return _commands.push(cmd);
 }
 
-void GameSystem::_init() {
-    // One-time setup point for global managers if needed
+void GameSystem::set_time_scale(int scale) {
+    _time_scale = (scale <= kTimeScaleMax) ? kTimeScaleMax : scale;
 }
 
-void GameSystem::_update(const float& dt) {
-    // Forward update to the active scene
-    if (_active_scene) _active_scene->update(dt);
+int GameSystem::get_time_scale() {
+    return _time_scale;
+}
+
+void GameSystem::cycle_time_scale() {
+    // 1x -> 2x -> 4x -> 8x -> max -> 1x
+    const int scale = _time_scale;
+    int next = 1;
+    if (scale == kTimeScaleMax) next = 1;
+    else if (scale >= 8)        next = kTimeScaleMax;
+    else                        next = scale * 2;
+
+    set_time_scale(next);
+    std::cout << "[GameSystem] Time scale: "
+        << (next == kTimeScaleMax ? std::string("max") : "x" + std::to_string(next))
+        << " (" << _substeps_sustainable.load() << " steps/frame sustainable)\n";
+}
+
+void GameSystem::_govern(float frameMs) {
+    // Sped up, frames are meant to be full; only judge the game at 1x
+    if (!_governor_enabled || _time_scale != 1) return;
+
+    // Busy time: this frame's drawing plus the sim steps behind it
+    const float busyMs = _render_stats.last(Stat::Render) +
+        _step_cost_ms.load() * static_cast<float>(std::max(_substeps_last.load(), 1));
+    const int level = _governor.update(frameMs, busyMs);
+
+    // The sim applies it between steps (and recordings keep it). If the
+    // queue is full we try again next frame.
+    if (level != _quality_sent) {
+        SimCommand cmd{ SimCommandType::SetQuality };
+        cmd.value = level;
+        if (post_command(cmd)) {
+            std::cout << "[GameSystem] Quality level " << level
+                << " (" << FrameGovernor::name(level) << ")\n";
+            _quality_sent = level;
+        }
+    }
+}
+
+void GameSystem::set_governor_enabled(bool enabled) {
+    _governor_enabled = enabled;
 }
 
-void GameSystem::_render(sf::RenderWindow& window) {
-    // Forward render to the active scene
-    if (_active_scene) _active_scene->render(window);
+int GameSystem::get_quality_level() {
+    return _governor.get_level();
+}
+
+int GameSystem::get_substeps_per_frame() {
+    return _substeps_last;
+}
+
+int GameSystem::get_sustainable_substeps() {
+    return _substeps_sustainable;
+}
+
+sf::RenderWindow& GameSystem::get_window() {
+    // Accessor for the global window
+    return *_window;
+}
+
+const Input& GameSystem::get_input() {
+    return _input;
+}
+
+void GameSystem::set_stats_overlay(bool visible) {
+    _show_stats = visible;
+}
+
+bool GameSystem::get_stats_overlay() {
+    return _show_stats;
+}
+
+const FrameStats& GameSystem::get_render_stats() {
+    return _render_stats;
+}
+
+const MemoryReport& GameSystem::get_render_memory() {
+    return _render_memory;
+}
+
+void GameSystem::set_session(const std::shared_ptr<GameSession>& session) {
+    _session = session;
+}
+
+const std::shared_ptr<GameSession>& GameSystem::get_session() {
+    return _session;
+}
+
+void GameSystem::clean() {
+    // Unload the session's scene and let the session go
+    if (_session) {
+        _session->clean();
+        _session.reset();
+    }
+}
+
+void GameSystem::_init() {
+    // Fresh session: the sim has no held keys yet
+    _last_held.reset();
+}
+
+void GameSystem::_update(const float& dt) {
+    // Forward update to the session's active scene
+    TRACE_SCOPE("GameSystem::_update");
+    if (_session) _session->update(dt);
 }
@@ -2,72 +2,196 @@
 // Game loop + Scene management
 
 #include <SFML/Graphics.hpp>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <string>
 
+#include "frame_governor.hpp"
+#include "frame_snapshot.hpp"
+#include "frame_stats.hpp"
+#include "input.hpp"
+#include "memory_report.hpp"
+#include "sim_command.hpp"
+#include "spsc_queue.hpp"
+
 class Entity; // forward declaration to avoid circular includes
+class GameSession;
+class MemoryReport;
+class StateHash;
 
 // -------------------------
 // Scene base class
 // -------------------------
 class Scene {
 public:
-    Scene() = default;
+    // Every scene belongs to one GameSession (its level, sibling scenes, input)
+    explicit Scene(GameSession& session) : _session(session) {}
     virtual ~Scene() = default;
 
-    // Called once per frame
+    // Called once per sim step (sim thread)
     virtual void update(const float& dt);
-    virtual void render(sf::RenderWindow& window);
+
+    // Describe what to draw for this step. Runs on the sim thread after
+    // update(); the render thread only ever sees the filled snapshot.
+    virtual void publish(FrameSnapshot& out) const;
+
+    // Player command from the input thread, applied before update()
+    virtual void handle_command(const SimCommand& cmd);
+
+    // Add this scene's live entities (and how many of them are bullets)
+    // for the stats counters. Default: the entity list.
+    virtual void count_live(size_t& entities, size_t& bullets) const;
+
+    // Feed this scene's simulation state into a checksum, in a fixed
+    // order (see state_hash.hpp). Default: entity positions.
+    virtual void hash_state(StateHash& h) const;
+
+    // Add the memory held by this scene's entities, buffers and HUD text
+    // to a footprint report (see memory_report.hpp). Default: nothing.
+    virtual void report_memory(MemoryReport& out) const;
 
     // Scene lifecycle hooks
     virtual void load() = 0;   // called when the scene becomes active
     virtual void unload();     // default: clear all entities
 
+    // Run prepare() once, if it hasn't run yet. GameSession calls this on
+    // its loader thread so a scene's first load() has nothing slow left.
+    void ensure_prepared();
+    bool is_prepared() const { return _prepared.load(std::memory_order_acquire); }
+
     // Access to the scenes entity list
     std::vector<std::shared_ptr<Entity>>& get_entities() { return _entities; }
 
 protected:
+    // One-off heavy setup (file I/O, parsing, path building). May run on a
+    // loader thread while this scene is being ticked in the background, so
+    // it must only write staging data that load() then takes over.
+    virtual void prepare() {}
+
+    GameSession& _session;
+
     // All entities owned by this scene
     std::vector<std::shared_ptr<Entity>> _entities;
+
+private:
+    std::atomic<bool> _prepared{ false };
 };
 
 // -------------------------
 // GameSystem - static helper
 // -------------------------
-// Owns the main window and runs the core game loop.
-// Only one active Scene exists at a time.
+// Owns the main window and runs the core game loop on two threads:
+//  - the sim thread steps the GameSession in fixed steps and publishes a
+//    FrameSnapshot after each batch of steps
+//  - the main thread polls window events and input, turns key presses into
+//    SimCommands, and draws the newest snapshot
+// All game state lives in the session; GameSystem only owns the window,
+// the loop and the hand-off between the two threads.
 class GameSystem {
 public:
     GameSystem() = delete; // purely static class
 
-    // Create window and run the main loop
+    // Create window and run the main loop.
+    // time_step > 0 runs the sim in fixed steps of that size;
+    // 0 falls back to one variable-dt update per sim loop.
     static void start(unsigned int width,
         unsigned int height,
         const std::string& name,
         const float& time_step = 0.0f);
 
-    // Global access to the SFML window (e.g. for mouse coords)
+    // Global access to the SFML window (main thread only)
     static sf::RenderWindow& get_window();
 
-    // Tear down current scene
-    static void clean();
+    // Input as sampled this frame (main thread)
+    static const Input& get_input();
+
+    // The session the window plays. Set before start(); the sim thread
+    // owns it while the loop runs.
+    static void set_session(const std::shared_ptr<GameSession>& session);
+    static const std::shared_ptr<GameSession>& get_session();
 
-    // Reload the current active scene
-    static void reset();
+    // Tear down the session's active scene and drop the session
+    static void clean();
 
-    // Change which scene is active (calls unload/load)
-    static void set_active_scene(const std::shared_ptr<Scene>& act_sc);
+    // Stats overlay (F3; any thread) and the render thread's own stats
+    static void set_stats_overlay(bool visible);
+    static bool get_stats_overlay();
+    static const FrameStats& get_render_stats();
+
+    // Render side of the memory footprint (font glyph pages, drawn text),
+    // measured when start() returns if the session tracks memory
+    static const MemoryReport& get_render_memory();
+
+    // Queue a player command for the sim thread (main thread only).
+    // Returns false if the queue is full and the command was dropped.
+    static bool post_command(const SimCommand& cmd);
+
+    // Turbo / time scale (any thread). The sim keeps its fixed step and
+    // runs `scale` steps per frame's worth of real time; kTimeScaleMax
+    // runs as many steps as fit in each frame.
+    static constexpr int kTimeScaleMax = 0;
+    static void set_time_scale(int scale);
+    static int  get_time_scale();
+    static void cycle_time_scale();   // 1x, 2x, 4x, 8x, max (T key)
+
+    // Frame governor (see frame_governor.hpp): on by default, degrading
+    // quality when frames run over the fixed step. Set before start().
+    static void set_governor_enabled(bool enabled);
+    static int  get_quality_level();
+
+    // Steps run in the last sim loop, and how many per frame this machine
+    // could sustain at the current per-step cost
+    static int get_substeps_per_frame();
+    static int get_sustainable_substeps();
 
 private:
     // Internal helpers for the main loop
     static void _init();
     static void _update(const float& dt);
-    static void _render(sf::RenderWindow& window);
+    static void _sim_loop(float time_step);
+    static void _apply_commands();
+    static void _publish(float time_step);
+    static void _post_input(std::chrono::steady_clock::time_point polled);
+    static void _govern(float frameMs);
 
-    // Currently active scene
-    static std::shared_ptr<Scene> _active_scene;
+    // Session being played (sim thread)
+    static std::shared_ptr<GameSession> _session;
 
     // Single global window owned by GameSystem
     static std::unique_ptr<sf::RenderWindow> _window;
+
+    // Per-frame input (main thread); the sim side lives in the session.
+    // _last_held is the held-key set last sent to the sim.
+    static Input _input;
+    static InputFrame::Bits _last_held;
+
+    // Frame / render / draw-call stats (main thread) and overlay toggle
+    static FrameStats        _render_stats;
+    static std::atomic<bool> _show_stats;
+    static MemoryReport      _render_memory;
+
+    // Sim -> render hand-off and render -> sim command queue
+    static SnapshotBuffer _snapshots;
+    static SpscQueue<SimCommand, 64> _commands;
+
+    // Cleared by the main thread to stop the sim thread
+    static std::atomic<bool> _running;
+
+    // Time scale and measured substep rates
+    static std::atomic<int> _time_scale;
+    static std::atomic<int> _substeps_last;
+    static std::atomic<int> _substeps_sustainable;
+    static std::atomic<float> _step_cost_ms;   // moving average per step
+
+    // Quality governor (main thread) and the level last sent to the sim
+    static FrameGovernor _governor;
+    static bool          _governor_enabled;
+    static int           _quality_sent;
+
+    // Fraction of a frame that sped-up stepping may use
+    static constexpr float kStepBudget = 0.9f;
+
+    // Longest frame we will try to catch up on in one go (seconds)
+    static constexpr float kMaxFrameTime = 0.25f;
 };
@@ -0,0 +1,757 @@
+// headless.cpp
+// Window-less simulation runner for soak tests and profiling.
+//
+// Builds the Safehouse + Tower Defence scenes, loads the TD level and steps
+// both simulations as fast as the CPU allows. No sf::RenderWindow
+// is created and nothing sleeps between ticks.
+//
+// Usage:
+//   tile_engine_headless [--ticks N] [--script file] [--no-autowave] [--serial]
+//                        [--sessions N] [--threads T] [--jobs W] [--no-jobs]
+//                        [--stats] [--trace file] [--allocs] [--zero-alloc]
+//                        [--hash] [--hash-out file] [--hash-check file]
+//                        [--hitch-ms T] [--memory] [--quality L]
+//   tile_engine_headless --replay file [--ticks N] [--jobs W] [--no-jobs]
+//                        [--stats] [--trace file]
+//                        [--hash] [--hash-out file] [--hash-check file]
+//                        [--hitch-ms T] [--memory]
+//
+// By default TD ticks on a worker thread in parallel with the Safehouse,
+// like in the game; --serial runs them one after the other for comparison.
+//
+// --sessions runs N independent GameSessions with the same inputs on a pool
+// of T threads (default: one per core). Each session then steps its two
+// sims serially; the parallelism comes from running sessions side by side.
+//
+// A single session splits big TD phases across a JobSystem like the game
+// does, with W worker threads (default: one per core, minus the ticking
+// thread); --no-jobs keeps every phase on the ticking thread.
+//
+// --stats prints the session's frame stats (per-phase times and live
+// counts over the last RollingStat::kWindow ticks) at the end.
+//
+// --trace records trace spans while running and writes the newest
+// Trace::kRingSize of each thread to `file` as Chrome trace JSON.
+//
+// --allocs (TILE_ENGINE_ALLOC_TRACKING builds, single session) prints the
+// sim's heap allocations per subsystem and for steady-state ticks: mid-wave
+// ticks after the first wave, when every container has grown to size.
+// --zero-alloc also fails the run (exit code 2) if any of those allocated.
+//
+// --hash checksums the simulation state after every tick (GameSession::
+// state_hash) and prints a rolling hash over the whole run; with
+// --sessions, "same outcome" then means bit-for-bit identical runs.
+// --hash-out writes the per-tick hashes to a golden file; --hash-check
+// compares against one and fails the run (exit code 3) at the first tick
+// that differs. Use them to prove an optimisation didn't change behaviour:
+// write the file with the reference build, check with the new one.
+//
+// --hitch-ms (single session) dumps the flight recorder to hitch_<tick>.csv
+// whenever a step takes longer than T ms (see flight_recorder.hpp), with
+// the trace alongside if --trace is on.
+//
+// --memory (single session) measures the memory footprint per subsystem
+// after every tick (see memory_report.hpp) and prints the end-of-run
+// footprint, the run's peak and each wave's peak. Use it to size the
+// reserves and to spot footprint regressions as the waves go on.
+//
+// --quality runs the session at frame governor level L (0-4, see
+// frame_governor.hpp). This loop ticks both sims directly, so only the
+// hit-flash step applies; replays go through GameSession::update() and
+// apply whatever levels the game recorded.
+//
+// --replay re-runs a recording made with `tile_engine --record file`: same
+// seed, same commands and scene switches at the same ticks, through the
+// same GameSession::update() the game uses, but as fast as possible. The
+// run stops at the end of the recording (or after --ticks, if sooner), so
+// a slow late-game moment can be reproduced and profiled on demand.
+//
+// Script files hold one scripted input per line, applied before that tick:
+//   <tick> wave              start the next wave (same as pressing E)
+//   <tick> turret <x> <y>    place a turret on grid tile x,y (same as F)
+//   <tick> spawn <type>      spawn a Safehouse invader (EnemyType as int)
+//   <tick> autowave on|off   auto-start waves whenever TD is waiting
+// Lines starting with '#' are ignored.
+
+#include "game_parameters.hpp"
+#include "game_systems.hpp"
+#include "game_session.hpp"
+#include "job_system.hpp"
+#include "replay.hpp"
+#include "scenes.hpp"
+#include "sim_worker.hpp"
+#include "state_hash.hpp"
+#include "memory_report.hpp"
+#include "trace.hpp"
+#include "alloc_tracker.hpp"
+
+#include <SFML/System/Clock.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using param = Parameters;
+
+namespace {
+
+// One scripted input, applied at the start of a given tick
+struct ScriptedInput {
+    long        tick = 0;
+    std::string command;
+    int         a = 0;
+    int         b = 0;
+};
+
+// Turret layout used when no script is given (empty tiles along the td_1 path)
+const sf::Vector2i kDefaultTurrets[] = {
+    { 4, 3 }, { 8, 3 }, { 11, 3 },
+    { 5, 5 }, { 9, 5 }, { 12, 5 },
+    { 4, 7 }, { 8, 7 }
+};
+
+bool load_script(const std::string& path, std::vector<ScriptedInput>& out) {
+    std::ifstream f(path);
+    if (!f.good()) {
+        std::cerr << "Couldn't open script file: " << path << "\n";
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream ss(line);
+        ScriptedInput in;
+        if (!(ss >> in.tick >> in.command)) continue;
+
+        if (in.command == "autowave") {
+            std::string onOff;
+            ss >> onOff;
+            in.a = (onOff == "on") ? 1 : 0;
+        }
+        else {
+            ss >> in.a >> in.b;
+        }
+        out.push_back(in);
+    }
+
+    // Apply in tick order regardless of file order
+    std::stable_sort(out.begin(), out.end(),
+        [](const ScriptedInput& l, const ScriptedInput& r) { return l.tick < r.tick; });
+    return true;
+}
+
+// Settings shared by every session in a run
+struct Options {
+    long                       ticks = 60L * 60L * 10L; // 10 minutes of game time at 60 Hz
+    std::vector<ScriptedInput> script;
+    bool                       autoWave = true;
+    bool                       trackAllocs = false;
+    bool                       hashState = false;
+    float                      hitchMs = 0.f;   // flight recorder threshold (0 = off)
+    bool                       trackMemory = false;
+    int                        quality = 0;     // frame governor level
+};
+
+// What one session got up to
+struct SessionResult {
+    long   ticks = 0;
+    double seconds = 0.0;
+    int    level = 0;
+    int    wave = 0;
+    bool   allWavesDone = false;
+    bool   playerDead = false;
+    size_t peakEnemies = 0;
+    size_t peakInvaders = 0;
+    size_t turrets = 0;
+
+    FrameStats::Report stats{};
+
+    // Allocation tracking (Options::trackAllocs)
+    AllocTracker::Counts allocs{};          // whole run, per scope
+    long                 steadyTicks = 0;   // mid-wave ticks after the first wave
+    long                 allocTicks = 0;    // ... of which allocated
+    long                 firstAllocTick = -1;
+    AllocTracker::Counts firstAllocs{};     // what that first tick allocated
+
+    // State checksums (Options::hashState): rolling over the run, per tick
+    std::uint64_t              stateHash = StateHash::kOffset;
+    std::vector<std::uint64_t> tickHashes;
+
+    int hitchDumps = 0;   // flight recorder dumps written (Options::hitchMs)
+
+    // Memory footprint (Options::trackMemory): last tick, run peak, per wave
+    MemoryReport              memory;
+    MemoryReport              memoryPeak;
+    std::vector<MemoryReport> waveMemory;
+};
+
+bool same_outcome(const SessionResult& a, const SessionResult& b) {
+    return a.ticks == b.ticks && a.level == b.level && a.wave == b.wave &&
+        a.allWavesDone == b.allWavesDone && a.playerDead == b.playerDead &&
+        a.peakEnemies == b.peakEnemies && a.peakInvaders == b.peakInvaders &&
+        a.turrets == b.turrets && a.stateHash == b.stateHash;
+}
+
+void record_hash(const GameSession& session, SessionResult& result) {
+    const std::uint64_t h = session.state_hash();
+    result.tickHashes.push_back(h);
+    result.stateHash = StateHash::combine(result.stateHash, h);
+}
+
+// Golden files: a header line, then "<tick> <hash>" (hex) per line
+bool write_hashes(const std::string& path, const std::vector<std::uint64_t>& hashes) {
+    std::ofstream f(path);
+    if (!f.good()) {
+        std::cerr << "Couldn't open " << path << " for writing\n";
+        return false;
+    }
+    f << "# dusk state hashes 1\n" << std::hex << std::setfill('0');
+    for (size_t tick = 0; tick < hashes.size(); ++tick) {
+        f << std::dec << tick << " " << std::hex << std::setw(16) << hashes[tick] << "\n";
+    }
+    return f.good();
+}
+
+// Compare a run against a golden file. Returns false (and says where) on
+// the first tick that differs or if the run lengths don't match.
+bool check_hashes(const std::string& path, const std::vector<std::uint64_t>& hashes) {
+    std::ifstream f(path);
+    if (!f.good()) {
+        std::cerr << "Couldn't open hash file: " << path << "\n";
+        return false;
+    }
+
+    std::string line;
+    size_t expected = 0;
+    while (std::getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream ss(line);
+        size_t        tick = 0;
+        std::uint64_t golden = 0;
+        if (!(ss >> tick >> std::hex >> golden) || tick != expected) {
+            std::cerr << "Bad line in hash file: " << line << "\n";
+            return false;
+        }
+        if (tick >= hashes.size()) {
+            std::cout << "[headless] hash check: run ended at tick " << hashes.size()
+                << ", golden file goes on\n";
+            return false;
+        }
+        if (hashes[tick] != golden) {
+            std::cout << "[headless] hash check: state differs at tick " << tick
+                << " (" << std::hex << hashes[tick] << " vs golden " << golden << std::dec << ")\n";
+            return false;
+        }
+        ++expected;
+    }
+    if (expected != hashes.size()) {
+        std::cout << "[headless] hash check: golden file ends at tick " << expected
+            << ", run went on to " << hashes.size() << "\n";
+        return false;
+    }
+    std::cout << "[headless] hash check: " << expected << " ticks match\n";
+    return true;
+}
+
+void keep_memory(const GameSession& session, SessionResult& result) {
+    result.memory = session.get_memory();
+    result.memoryPeak = session.get_memory_peak();
+    result.waveMemory = session.get_wave_memory_peaks();
+}
+
+// Build one session and step it until the tick limit, player death or the
+// last wave. `parallelTd` ticks TD on the session's worker thread; `jobs`
+// (optional) splits big TD phases across cores.
+SessionResult run_session(const Options& opt, bool parallelTd, JobSystem* jobs) {
+    // Same scene setup as the windowed game
+    GameSession session;
+    session.set_job_system(jobs);
+    session.flight_recorder().set_threshold_ms(opt.hitchMs);
+    session.set_memory_tracking(opt.trackMemory);
+    if (opt.quality > 0) {
+        // Same path as the game's governor
+        SimCommand cmd{ SimCommandType::SetQuality };
+        cmd.value = opt.quality;
+        session.handle_command(cmd);
+    }
+
+    auto sh = std::static_pointer_cast<SafehouseScene>(session.safehouse);
+    auto td = std::static_pointer_cast<TowerDefenceScene>(session.tower_defence);
+
+    // Safehouse is the active scene; TD is loaded up front so its level,
+    // path and wave manager exist before the first tick
+    session.set_active_scene(session.safehouse);
+    td->load();
+
+    if (opt.script.empty()) {
+        for (const auto& grid : kDefaultTurrets) {
+            td->place_turret_at(grid);
+        }
+    }
+
+    const float dt = param::time_step;
+    SimWorker& worker = session.background_sim();
+    TowerDefenceScene* tdSim = td.get();
+    const std::vector<ScriptedInput>& script = opt.script;
+    bool   autoWave = opt.autoWave;
+    size_t nextInput = 0;
+    SessionResult result;
+    long   tick = 0;
+
+    AllocTracker::Counts runStart{}, before{}, after{};
+    if (opt.trackAllocs) AllocTracker::counts(runStart);
+
+    sf::Clock clock;
+
+    for (; tick < opt.ticks; ++tick) {
+        Trace::set_frame(static_cast<std::uint64_t>(tick));
+
+        // Feed scripted inputs due this tick
+        while (nextInput < script.size() && script[nextInput].tick <= tick) {
+            const ScriptedInput& in = script[nextInput++];
+            if (in.command == "wave") {
+                td->start_next_wave();
+            }
+            else if (in.command == "turret") {
+                td->place_turret_at({ in.a, in.b });
+            }
+            else if (in.command == "spawn") {
+                sh->spawn_invaders({ in.a });
+            }
+            else if (in.command == "autowave") {
+                autoWave = (in.a != 0);
+            }
+            else {
+                std::cerr << "Unknown script command: " << in.command << "\n";
+            }
+        }
+
+        if (autoWave && td->isWaitingForPlayer()) {
+            td->start_next_wave();
+        }
+
+        // Steady state: a wave is running and every earlier wave has
+        // already grown the containers
+        const bool steady = opt.trackAllocs &&
+            !td->isWaitingForPlayer() && !td->hasFinishedAllWaves() &&
+            (td->getCurrentLevelIndex() > 0 || td->getCurrentWaveIndex() > 0);
+        if (steady) AllocTracker::counts(before);
+
+        // Step both sims. Escaped enemies cross over through TD's queue.
+        {
+            ScopedStatTimer timer(session.get_stats(), Stat::Update);
+            if (parallelTd) {
+                worker.run([tdSim, dt] { tdSim->tick_simulation(dt); });
+                sh->tick_simulation(dt);
+                worker.wait();
+            }
+            else {
+                td->tick_simulation(dt);
+                sh->tick_simulation(dt);
+            }
+            td->flush_escaped_enemies();
+        }
+        session.end_step();
+        if (opt.hashState) record_hash(session, result);
+
+        if (steady) {
+            AllocTracker::counts(after);
+            bool allocated = false;
+            for (size_t i = 0; i < AllocTracker::kScopeCount; ++i) {
+                after[i] -= before[i];
+                allocated = allocated ||
+                    (after[i] > 0 && AllocTracker::is_sim(static_cast<AllocScope>(i)));
+            }
+            ++result.steadyTicks;
+            if (allocated) {
+                if (result.allocTicks == 0) {
+                    result.firstAllocTick = tick;
+                    result.firstAllocs = after;
+                }
+                ++result.allocTicks;
+            }
+        }
+
+        result.peakEnemies = std::max(result.peakEnemies, td->get_enemy_count());
+        result.peakInvaders = std::max(result.peakInvaders, sh->get_invader_count());
+
+        if (sh->is_player_dead() || td->hasFinishedAllWaves()) {
+            ++tick;
+            break;
+        }
+    }
+
+    result.seconds = clock.getElapsedTime().asSeconds();
+    result.ticks = tick;
+    result.level = td->getCurrentLevelIndex() + 1;
+    result.wave = td->getCurrentWaveIndex() + 1;
+    result.allWavesDone = td->hasFinishedAllWaves();
+    result.playerDead = sh->is_player_dead();
+    result.turrets = td->get_turret_count();
+    session.get_stats().report(result.stats);
+    result.hitchDumps = session.flight_recorder().dumps_written();
+    if (opt.trackMemory) keep_memory(session, result);
+    if (opt.trackAllocs) {
+        AllocTracker::counts(result.allocs);
+        for (size_t i = 0; i < AllocTracker::kScopeCount; ++i) result.allocs[i] -= runStart[i];
+    }
+
+    session.clean();
+    return result;
+}
+
+// Step a fresh session through a recording at full speed
+SessionResult run_replay(const Replay& replay, const Options& opt, long maxTicks, JobSystem* jobs) {
+    GameSession session;
+    session.set_job_system(jobs);
+    session.flight_recorder().set_threshold_ms(opt.hitchMs);
+    session.set_memory_tracking(opt.trackMemory);
+    session.set_seed(replay.seed);
+    session.set_replaying(true);
+
+    auto sh = std::static_pointer_cast<SafehouseScene>(session.safehouse);
+    auto td = std::static_pointer_cast<TowerDefenceScene>(session.tower_defence);
+
+    // Same start as the windowed game
+    session.set_active_scene(session.safehouse);
+    session.prewarm(session.tower_defence);
+
+    const std::uint64_t ticks = std::min<std::uint64_t>(replay.ticks, static_cast<std::uint64_t>(maxTicks));
+    size_t nextEvent = 0;
+    SessionResult result;
+
+    sf::Clock clock;
+
+    for (std::uint64_t tick = 0; tick < ticks; ++tick) {
+        // Everything the game applied before this step, in the same order
+        while (nextEvent < replay.events.size() && replay.events[nextEvent].tick <= tick) {
+            session.apply_replay_event(replay.events[nextEvent++]);
+        }
+
+        session.update(replay.step);
+        if (opt.hashState) record_hash(session, result);
+
+        result.peakEnemies = std::max(result.peakEnemies, td->get_enemy_count());
+        result.peakInvaders = std::max(result.peakInvaders, sh->get_invader_count());
+    }
+
+    result.seconds = clock.getElapsedTime().asSeconds();
+    result.ticks = static_cast<long>(session.get_tick());
+    result.level = td->getCurrentLevelIndex() + 1;
+    result.wave = td->getCurrentWaveIndex() + 1;
+    result.allWavesDone = td->hasFinishedAllWaves();
+    result.playerDead = sh->is_player_dead();
+    result.turrets = td->get_turret_count();
+    session.get_stats().report(result.stats);
+    result.hitchDumps = session.flight_recorder().dumps_written();
+    if (opt.trackMemory) keep_memory(session, result);
+
+    session.clean();
+    return result;
+}
+
+void print_memory(const SessionResult& r) {
+    std::cout << "\n[headless] memory at the end of the run:\n" << r.memory.format()
+        << "\n[headless] memory peak over the run:\n" << r.memoryPeak.format()
+        << "\n[headless] memory peak per wave (live KiB):\n"
+        << MemoryReport::format_waves(r.waveMemory, WaveManager::kWavesPerLevel);
+}
+
+// Print the run's rolling state hash, then write and/or check the golden
+// file. Returns the exit code: 0, 1 (couldn't write) or 3 (check failed).
+int report_hashes(const SessionResult& r, const std::string& outPath, const std::string& checkPath) {
+    std::cout << "[headless] state hash:     " << std::hex << std::setfill('0') << std::setw(16)
+        << r.stateHash << std::dec << std::setfill(' ') << " over " << r.tickHashes.size() << " ticks\n";
+    if (!outPath.empty()) {
+        if (!write_hashes(outPath, r.tickHashes)) return 1;
+        std::cout << "[headless] wrote per-tick hashes to " << outPath << "\n";
+    }
+    if (!checkPath.empty() && !check_hashes(checkPath, r.tickHashes)) {
+        std::cout << "[headless] FAILED: state differs from " << checkPath << "\n";
+        return 3;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options     opt;
+    std::string scriptPath;
+    std::string tracePath;
+    std::string replayPath;
+    std::string hashOutPath;
+    std::string hashCheckPath;
+    bool        ticksGiven = false;
+    bool        serial = false;
+    bool        useJobs = true;
+    bool        printStats = false;
+    bool        zeroAlloc = false;
+    unsigned    jobWorkers = 0;
+    int         sessions = 1;
+    int         threads = static_cast<int>(std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--ticks" && i + 1 < argc) {
+            opt.ticks = std::stol(argv[++i]);
+            ticksGiven = true;
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+        else if (arg == "--hitch-ms" && i + 1 < argc) {
+            opt.hitchMs = std::stof(argv[++i]);
+        }
+        else if (arg == "--quality" && i + 1 < argc) {
+            opt.quality = std::stoi(argv[++i]);
+        }
+        else if (arg == "--memory") {
+            opt.trackMemory = true;
+        }
+        else if (arg == "--hash") {
+            opt.hashState = true;
+        }
+        else if (arg == "--hash-out" && i + 1 < argc) {
+            opt.hashState = true;
+            hashOutPath = argv[++i];
+        }
+        else if (arg == "--hash-check" && i + 1 < argc) {
+            opt.hashState = true;
+            hashCheckPath = argv[++i];
+        }
+        else if (arg == "--script" && i + 1 < argc) {
+            scriptPath = argv[++i];
+        }
+        else if (arg == "--no-autowave") {
+            opt.autoWave = false;
+        }
+        else if (arg == "--serial") {
+            serial = true;
+        }
+        else if (arg == "--jobs" && i + 1 < argc) {
+            jobWorkers = static_cast<unsigned>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--stats") {
+            printStats = true;
+        }
+        else if (arg == "--allocs") {
+            opt.trackAllocs = true;
+        }
+        else if (arg == "--zero-alloc") {
+            opt.trackAllocs = true;
+            zeroAlloc = true;
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        }
+        else if (arg == "--no-jobs") {
+            useJobs = false;
+        }
+        else if (arg == "--sessions" && i + 1 < argc) {
+            sessions = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::stoi(argv[++i]);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0]
+                << " [--ticks N] [--script file] [--no-autowave] [--serial]"
+                << " [--sessions N] [--threads T] [--jobs W] [--no-jobs] [--stats]"
+                << " [--trace file] [--allocs] [--zero-alloc]"
+                << " [--hash] [--hash-out file] [--hash-check file] [--hitch-ms T] [--memory]"
+                << " [--quality L]\n"
+                << "       " << argv[0]
+                << " --replay file [--ticks N] [--jobs W] [--no-jobs] [--stats] [--trace file]"
+                << " [--hash] [--hash-out file] [--hash-check file] [--hitch-ms T] [--memory]\n";
+            return 1;
+        }
+    }
+
+    if (!scriptPath.empty() && !load_script(scriptPath, opt.script)) {
+        return 1;
+    }
+
+    if (opt.trackAllocs && !AllocTracker::kEnabled) {
+        std::cerr << "--allocs / --zero-alloc need a build configured with"
+            << " -DTILE_ENGINE_ALLOC_TRACKING=ON\n";
+        return 1;
+    }
+    if (opt.trackAllocs && sessions > 1) {
+        std::cerr << "--allocs / --zero-alloc count process-wide; use a single session\n";
+        return 1;
+    }
+    if ((!hashOutPath.empty() || !hashCheckPath.empty()) && sessions > 1) {
+        std::cerr << "--hash-out / --hash-check need a single session\n";
+        return 1;
+    }
+    if (opt.hitchMs > 0.f && sessions > 1) {
+        std::cerr << "--hitch-ms needs a single session\n";
+        return 1;
+    }
+    if (opt.trackMemory && sessions > 1) {
+        std::cerr << "--memory needs a single session\n";
+        return 1;
+    }
+
+    if (!tracePath.empty()) {
+        Trace::set_enabled(true);
+        Trace::set_thread_name("headless");
+    }
+
+    if (!replayPath.empty()) {
+        Replay replay;
+        if (!replay.load(replayPath)) return 1;
+
+        std::unique_ptr<JobSystem> jobs;
+        if (useJobs) jobs = std::make_unique<JobSystem>(jobWorkers);
+
+        const SessionResult r = run_replay(replay, opt, ticksGiven ? opt.ticks : static_cast<long>(replay.ticks), jobs.get());
+
+        std::cout << "\n[headless] replay:         " << replayPath
+            << " (seed " << replay.seed << ", " << replay.events.size() << " events)"
+            << "\n[headless] ticks:          " << r.ticks << " of " << replay.ticks
+            << "\n[headless] wall time:      " << r.seconds << " s"
+            << "\n[headless] ticks/sec:      " << (r.seconds > 0.0 ? r.ticks / r.seconds : 0.0)
+            << "\n[headless] us/tick:        " << (r.ticks > 0 ? r.seconds * 1e6 / r.ticks : 0.0)
+            << "\n[headless] reached:        Level " << r.level
+            << " - Wave " << r.wave
+            << (r.allWavesDone ? " (all waves complete)" : "")
+            << "\n[headless] player dead:    " << (r.playerDead ? "yes" : "no")
+            << "\n[headless] peak enemies:   " << r.peakEnemies
+            << "\n[headless] peak invaders:  " << r.peakInvaders
+            << "\n[headless] turrets:        " << r.turrets
+            << "\n";
+        if (opt.hitchMs > 0.f) {
+            std::cout << "[headless] hitch dumps:    " << r.hitchDumps
+                << " (steps over " << opt.hitchMs << " ms)\n";
+        }
+        if (printStats) {
+            std::cout << "\n[headless] stats over the last " << RollingStat::kWindow
+                << " ticks (ms / counts):\n"
+                << FrameStats::format(r.stats, replay.step * 1000.f);
+        }
+        if (opt.trackMemory) print_memory(r);
+        if (!tracePath.empty() && !Trace::write_chrome_json(tracePath)) return 1;
+        if (opt.hashState) return report_hashes(r, hashOutPath, hashCheckPath);
+        return 0;
+    }
+
+    if (sessions == 1) {
+        std::unique_ptr<JobSystem> jobs;
+        if (useJobs) jobs = std::make_unique<JobSystem>(jobWorkers);
+
+        const SessionResult r = run_session(opt, !serial, jobs.get());
+
+        std::cout << "\n[headless] ticks:          " << r.ticks
+            << "\n[headless] wall time:      " << r.seconds << " s"
+            << "\n[headless] ticks/sec:      " << (r.seconds > 0.0 ? r.ticks / r.seconds : 0.0)
+            << "\n[headless] us/tick:        " << (r.ticks > 0 ? r.seconds * 1e6 / r.ticks : 0.0)
+            << "\n[headless] reached:        Level " << r.level
+            << " - Wave " << r.wave
+            << (r.allWavesDone ? " (all waves complete)" : "")
+            << "\n[headless] player dead:    " << (r.playerDead ? "yes" : "no")
+            << "\n[headless] peak enemies:   " << r.peakEnemies
+            << "\n[headless] peak invaders:  " << r.peakInvaders
+            << "\n[headless] turrets:        " << r.turrets
+            << "\n";
+        if (opt.hitchMs > 0.f) {
+            std::cout << "[headless] hitch dumps:    " << r.hitchDumps
+                << " (steps over " << opt.hitchMs << " ms)\n";
+        }
+        if (printStats) {
+            std::cout << "\n[headless] stats over the last " << RollingStat::kWindow
+                << " ticks (ms / counts):\n"
+                << FrameStats::format(r.stats, param::time_step * 1000.f);
+        }
+        if (opt.trackMemory) print_memory(r);
+        if (opt.trackAllocs) {
+            std::cout << "\n[headless] heap allocations over the run:\n";
+            for (size_t i = 0; i < AllocTracker::kScopeCount; ++i) {
+                std::cout << "[headless]   " << std::left << std::setw(12)
+                    << AllocTracker::name(static_cast<AllocScope>(i)) << std::right
+                    << std::setw(10) << r.allocs[i] << "\n";
+            }
+            std::cout << "[headless] steady-state ticks: " << r.steadyTicks
+                << ", " << r.allocTicks << " of them allocated\n";
+            if (r.allocTicks > 0) {
+                std::cout << "[headless] first at tick " << r.firstAllocTick << ":";
+                for (size_t i = 0; i < AllocTracker::kScopeCount; ++i) {
+                    if (r.firstAllocs[i] > 0) {
+                        std::cout << " " << AllocTracker::name(static_cast<AllocScope>(i))
+                            << "=" << r.firstAllocs[i];
+                    }
+                }
+                std::cout << "\n";
+            }
+        }
+        if (!tracePath.empty() && !Trace::write_chrome_json(tracePath)) return 1;
+        if (opt.hashState) {
+            const int code = report_hashes(r, hashOutPath, hashCheckPath);
+            if (code != 0) return code;
+        }
+        if (zeroAlloc && r.allocTicks > 0) {
+            std::cout << "[headless] FAILED: steady-state ticks allocated\n";
+            return 2;
+        }
+        return 0;
+    }
+
+    // Session pool: each thread takes the next unstarted session until none
+    // are left. Sessions share nothing, so no other synchronisation is needed.
+    threads = std::max(1, std::min(threads, sessions));
+    std::vector<SessionResult> results(static_cast<size_t>(sessions));
+    std::atomic<int> nextSession{ 0 };
+
+    sf::Clock clock;
+
+    std::vector<std::thread> pool;
+    pool.reserve(static_cast<size_t>(threads));
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&] {
+            for (int i = nextSession++; i < sessions; i = nextSession++) {
+                results[static_cast<size_t>(i)] = run_session(opt, false, nullptr);
+            }
+            });
+    }
+    for (auto& th : pool) th.join();
+
+    const double seconds = clock.getElapsedTime().asSeconds();
+
+    long   totalTicks = 0;
+    double sessionSeconds = 0.0;
+    int    dead = 0;
+    int    finished = 0;
+    bool   identical = true;
+    for (const auto& r : results) {
+        totalTicks += r.ticks;
+        sessionSeconds += r.seconds;
+        dead += r.playerDead ? 1 : 0;
+        finished += r.allWavesDone ? 1 : 0;
+        identical = identical && same_outcome(r, results.front());
+    }
+
+    std::cout << "\n[headless] sessions:       " << sessions << " on " << threads << " threads"
+        << "\n[headless] total ticks:    " << totalTicks
+        << "\n[headless] wall time:      " << seconds << " s"
+        << "\n[headless] ticks/sec:      " << (seconds > 0.0 ? totalTicks / seconds : 0.0)
+        << "\n[headless] us/tick:        " << (totalTicks > 0 ? sessionSeconds * 1e6 / totalTicks : 0.0)
+        << " (per session)"
+        << "\n[headless] all waves done: " << finished << "/" << sessions
+        << "\n[headless] player dead:    " << dead << "/" << sessions
+        << "\n[headless] same outcome:   " << (identical ? "yes" : "no")
+        << (opt.hashState ? " (state hashes compared)" : "")
+        << "\n";
+    if (!tracePath.empty() && !Trace::write_chrome_json(tracePath)) return 1;
+    return 0;
+}
@@ -0,0 +1,71 @@
+// input.cpp
+#include "input.hpp"
+
+void Input::handle_event(const sf::Event& event) {
+    switch (event.type) {
+    case sf::Event::KeyPressed:
+    case sf::Event::KeyReleased:
+        // Unknown keys (-1) and anything past KeyCount are ignored
+        if (event.key.code >= 0 && event.key.code < sf::Keyboard::KeyCount) {
+            set_bit(InputFrame::bit(event.key.code),
+                event.type == sf::Event::KeyPressed);
+        }
+        break;
+
+    case sf::Event::MouseButtonPressed:
+    case sf::Event::MouseButtonReleased:
+        if (event.mouseButton.button < sf::Mouse::ButtonCount) {
+            set_bit(InputFrame::bit(event.mouseButton.button),
+                event.type == sf::Event::MouseButtonPressed);
+        }
+        _mousePixel = { event.mouseButton.x, event.mouseButton.y };
+        break;
+
+    case sf::Event::MouseMoved:
+        _mousePixel = { event.mouseMove.x, event.mouseMove.y };
+        break;
+
+    case sf::Event::LostFocus:
+        // We won't see the key-ups, so treat everything as released
+        _released |= _held;
+        _held.reset();
+        break;
+
+    default:
+        break;
+    }
+}
+
+void Input::set_bit(std::size_t bit, bool down) {
+    if (down) {
+        // Key repeat sends more KeyPressed events; only the first is an edge
+        if (!_held[bit]) _pressed[bit] = true;
+        _held[bit] = true;
+    }
+    else {
+        if (_held[bit]) _released[bit] = true;
+        _held[bit] = false;
+    }
+}
+
+void Input::end_frame(const sf::RenderWindow& window) {
+    _frame.held = _held;
+    _frame.pressed = _pressed;
+    _frame.released = _released;
+    _frame.mouseWorld = window.mapPixelToCoords(_mousePixel);
+
+    _pressed.reset();
+    _released.reset();
+}
+
+bool Input::held(sf::Keyboard::Key key) const {
+    return key >= 0 && _frame.held[InputFrame::bit(key)];
+}
+
+bool Input::pressed(sf::Keyboard::Key key) const {
+    return key >= 0 && _frame.pressed[InputFrame::bit(key)];
+}
+
+bool Input::released(sf::Keyboard::Key key) const {
+    return key >= 0 && _frame.released[InputFrame::bit(key)];
+}
@@ -0,0 +1,61 @@
+// input.hpp
+#pragma once
+// Per-frame keyboard + mouse snapshot.
+//
+// The main thread feeds window events in as they arrive and seals one
+// InputFrame per frame; queries after that are plain bit tests, with no
+// OS polling and no hashing. Frames can also be fed in from a recorded
+// stream instead of the window.
+
+#include <SFML/Graphics.hpp>
+#include <bitset>
+#include <cstddef>
+
+struct InputFrame {
+    static constexpr std::size_t kKeys = sf::Keyboard::KeyCount;
+    static constexpr std::size_t kButtons = sf::Mouse::ButtonCount;
+    using Bits = std::bitset<kKeys + kButtons>;
+
+    Bits         held;       // down at the end of the frame
+    Bits         pressed;    // went down during the frame (even if released again)
+    Bits         released;   // went up during the frame
+    sf::Vector2f mouseWorld; // mouse position in world coords
+
+    // Bit index for a key / mouse button (keys first, then buttons)
+    static std::size_t bit(sf::Keyboard::Key key) { return static_cast<std::size_t>(key); }
+    static std::size_t bit(sf::Mouse::Button button) { return kKeys + static_cast<std::size_t>(button); }
+};
+
+class Input {
+public:
+    // Main thread: update from a window event (call for every polled event)
+    void handle_event(const sf::Event& event);
+
+    // Main thread: seal everything since the last call into frame()
+    void end_frame(const sf::RenderWindow& window);
+
+    // Use a recorded / forwarded frame as the current one
+    void feed(const InputFrame& frame) { _frame = frame; }
+
+    const InputFrame& frame() const { return _frame; }
+
+    // Queries against the current frame
+    bool held(sf::Keyboard::Key key) const;
+    bool pressed(sf::Keyboard::Key key) const;
+    bool released(sf::Keyboard::Key key) const;
+    bool held(sf::Mouse::Button button) const { return _frame.held[InputFrame::bit(button)]; }
+    bool pressed(sf::Mouse::Button button) const { return _frame.pressed[InputFrame::bit(button)]; }
+    bool released(sf::Mouse::Button button) const { return _frame.released[InputFrame::bit(button)]; }
+    sf::Vector2f mouse_world() const { return _frame.mouseWorld; }
+
+private:
+    void set_bit(std::size_t bit, bool down);
+
+    InputFrame       _frame;      // last sealed frame
+
+    // Accumulated from events since the last end_frame()
+    InputFrame::Bits _held;
+    InputFrame::Bits _pressed;
+    InputFrame::Bits _released;
+    sf::Vector2i     _mousePixel;
+};
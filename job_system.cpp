@@ -0,0 +1,216 @@
+// job_system.cpp
+#include "job_system.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+namespace {
+// Which JobSystem / queue the current thread works for (workers only)
+thread_local const JobSystem* t_owner = nullptr;
+thread_local std::size_t      t_queue = 0;
+}
+
+JobSystem::JobSystem(unsigned int workers) {
+    if (workers == 0) {
+        const unsigned int cores = std::thread::hardware_concurrency();
+        workers = (cores > 1) ? cores - 1 : 0;
+    }
+
+    for (unsigned int i = 0; i <= workers; ++i) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+
+    _workers.reserve(workers);
+    for (unsigned int i = 0; i < workers; ++i) {
+        _workers.emplace_back(&JobSystem::worker_loop, this, static_cast<std::size_t>(i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _quit = true;
+    }
+    _workAvailable.notify_all();
+    for (auto& t : _workers) t.join();
+}
+
+// -------------------------
+// Submitting
+// -------------------------
+
+JobSystem::JobHandle JobSystem::submit(std::function<void()> fn,
+    std::initializer_list<JobHandle> deps)
+{
+    return make_job(std::move(fn), deps.begin(), deps.size());
+}
+
+JobSystem::JobHandle JobSystem::parallel_for(std::size_t count, std::size_t grain,
+    std::function<void(std::size_t, std::size_t)> fn,
+    std::initializer_list<JobHandle> deps)
+{
+    grain = std::max<std::size_t>(grain, 1);
+
+    // Chunks share one copy of the body
+    auto body = std::make_shared<std::function<void(std::size_t, std::size_t)>>(std::move(fn));
+
+    std::vector<JobHandle> chunks;
+    chunks.reserve((count + grain - 1) / grain);
+    for (std::size_t begin = 0; begin < count; begin += grain) {
+        const std::size_t end = std::min(begin + grain, count);
+        chunks.push_back(make_job([body, begin, end] { (*body)(begin, end); },
+            deps.begin(), deps.size()));
+    }
+
+    // Empty job that finishes once every chunk has (or straight after deps
+    // when there is nothing to do)
+    if (chunks.empty()) {
+        return make_job(nullptr, deps.begin(), deps.size());
+    }
+    return make_job(nullptr, chunks.data(), chunks.size());
+}
+
+JobSystem::JobHandle JobSystem::make_job(std::function<void()> fn,
+    const JobHandle* deps, std::size_t depCount)
+{
+    auto job = std::make_shared<Job>();
+    job->fn = std::move(fn);
+    job->frame = Trace::get_frame();
+
+    for (std::size_t i = 0; i < depCount; ++i) {
+        Job* dep = deps[i].get();
+        if (!dep) continue;
+
+        std::lock_guard<std::mutex> lock(dep->mutex);
+        if (!dep->done.load(std::memory_order_acquire)) {
+            job->waitingOn.fetch_add(1, std::memory_order_relaxed);
+            dep->dependents.push_back(job);
+        }
+    }
+
+    // Drop the wiring reference; runnable now if nothing was pending
+    if (job->waitingOn.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        push(job);
+    }
+    return job;
+}
+
+// -------------------------
+// Queues
+// -------------------------
+
+std::size_t JobSystem::home_queue() const {
+    // Workers use their own queue; anyone else uses the shared last one
+    return (t_owner == this) ? t_queue : _queues.size() - 1;
+}
+
+void JobSystem::push(const JobHandle& job) {
+    Queue& q = *_queues[home_queue()];
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.jobs.push_back(job);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    _workAvailable.notify_one();
+}
+
+JobSystem::JobHandle JobSystem::pop(std::size_t home) {
+    // Own queue first, newest job (still warm in cache)
+    {
+        Queue& q = *_queues[home];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.jobs.empty()) {
+            JobHandle job = std::move(q.jobs.back());
+            q.jobs.pop_back();
+            _queued.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    // Then steal the oldest job from someone else
+    const std::size_t n = _queues.size();
+    for (std::size_t i = 1; i < n; ++i) {
+        Queue& q = *_queues[(home + i) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.jobs.empty()) {
+            JobHandle job = std::move(q.jobs.front());
+            q.jobs.pop_front();
+            _queued.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+// -------------------------
+// Running
+// -------------------------
+
+void JobSystem::run(const JobHandle& job) {
+    // Spans belong to the submitter's frame; wait() may run another
+    // session's job on a sim thread, so put its own frame back after
+    const std::uint64_t frame = Trace::get_frame();
+    Trace::set_frame(job->frame);
+    if (job->fn) job->fn();
+    Trace::set_frame(frame);
+
+    std::vector<JobHandle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->done.store(true, std::memory_order_release);
+        dependents.swap(job->dependents);
+    }
+
+    // Release anything that was only waiting on us
+    for (const auto& d : dependents) {
+        if (d->waitingOn.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            push(d);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _jobFinished.notify_all();
+}
+
+void JobSystem::worker_loop(std::size_t index) {
+    t_owner = this;
+    t_queue = index;
+    Trace::set_thread_name("job worker " + std::to_string(index));
+
+    for (;;) {
+        if (JobHandle job = pop(index)) {
+            run(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _workAvailable.wait(lock, [this] { return _quit || _queued.load() > 0; });
+        if (_quit) return;
+    }
+}
+
+void JobSystem::wait(const JobHandle& job) {
+    if (!job) return;
+
+    const std::size_t home = home_queue();
+    while (!job->done.load(std::memory_order_acquire)) {
+        if (JobHandle other = pop(home)) {
+            run(other);
+            continue;
+        }
+
+        // Nothing to help with: sleep until a job finishes or more work
+        // turns up (the timeout covers a finish we just missed)
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _jobFinished.wait_for(lock, std::chrono::microseconds(200), [&] {
+            return job->done.load(std::memory_order_acquire) || _queued.load() > 0;
+            });
+    }
+}
@@ -0,0 +1,89 @@
+// job_system.hpp
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing job scheduler for splitting a sim phase across cores.
+//  - Each worker has its own queue: it takes its newest job first and,
+//    when empty, steals the oldest job from another queue
+//  - A job can depend on other jobs and only becomes runnable once they
+//    have all finished
+//  - wait() runs queued jobs on the calling thread until the one it is
+//    waiting for is done, so the sim thread helps instead of idling
+//
+//   auto move  = jobs.parallel_for(n, 256, [&](size_t b, size_t e) { ... });
+//   auto after = jobs.submit([&] { ... }, { move });
+//   jobs.wait(after);
+class JobSystem {
+public:
+    struct Job;
+    using JobHandle = std::shared_ptr<Job>;
+
+    // workers = 0 uses one thread per core, minus the caller's own
+    explicit JobSystem(unsigned int workers = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Run `fn` once every job in `deps` has finished
+    JobHandle submit(std::function<void()> fn, std::initializer_list<JobHandle> deps = {});
+
+    // Run fn(begin, end) over [0, count) in chunks of at most `grain`,
+    // after `deps`. The returned job finishes when every chunk has.
+    JobHandle parallel_for(std::size_t count, std::size_t grain,
+        std::function<void(std::size_t, std::size_t)> fn,
+        std::initializer_list<JobHandle> deps = {});
+
+    // Block until `job` has finished, running other jobs meanwhile
+    void wait(const JobHandle& job);
+
+    unsigned int get_worker_count() const { return static_cast<unsigned int>(_workers.size()); }
+
+private:
+    struct Queue {
+        std::mutex            mutex;
+        std::deque<JobHandle> jobs;
+    };
+
+    JobHandle make_job(std::function<void()> fn, const JobHandle* deps, std::size_t depCount);
+    void      push(const JobHandle& job);
+    JobHandle pop(std::size_t home);
+    void      run(const JobHandle& job);
+    void      worker_loop(std::size_t index);
+    std::size_t home_queue() const;
+
+    // One queue per worker, plus one for jobs pushed by other threads
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread>            _workers;
+
+    // Jobs sitting in queues; sleepers wake when this goes above zero
+    std::atomic<int>        _queued{ 0 };
+    std::mutex              _sleepMutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _jobFinished;
+    bool                    _quit = false;
+};
+
+struct JobSystem::Job {
+    std::function<void()> fn;
+    std::uint64_t         frame = 0;   // submitter's trace frame
+
+    // Unfinished dependencies, plus one held by make_job() while wiring up
+    std::atomic<int>  waitingOn{ 1 };
+    std::atomic<bool> done{ false };
+
+    // Jobs to release when this one finishes (guarded by mutex)
+    std::mutex             mutex;
+    std::vector<JobHandle> dependents;
+};
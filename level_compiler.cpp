@@ -0,0 +1,43 @@
+// level_compiler.cpp
+// Build-time converter from text levels to the compiled format the game
+// maps at load (see tile_level_loader/level_file.hpp).
+//
+// Usage:
+//   tile_level_compiler <level.txt> [out.lvl]
+//
+// The output defaults to LevelSystem::compiled_path(level.txt), i.e. next
+// to the text file. The build runs this for every res/levels/*.txt and
+// copies the results next to the game's resources, so editing a level
+// only needs a rebuild. Exits with 1 if the level can't be parsed or the
+// output can't be written.
+
+#include "tile_level_loader/level_system.hpp"
+
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: tile_level_compiler <level.txt> [out.lvl]\n";
+        return 1;
+    }
+    const std::string textPath = argv[1];
+    const std::string outPath = (argc == 3) ? argv[2] : LevelSystem::compiled_path(textPath);
+
+    try {
+        // Tile size doesn't matter here: the file only holds grid data.
+        // The source hash lets the game spot a stale compiled copy.
+        LevelSystem level;
+        level.load_level(textPath);
+        level.save_compiled(outPath, LevelSystem::source_hash(textPath));
+
+        std::cout << "[level_compiler] " << textPath << " -> " << outPath << " ("
+            << level.get_width() << "x" << level.get_height() << ", "
+            << level.get_path().size() << " path nodes)\n";
+    }
+    catch (const std::string& error) {
+        std::cerr << "[level_compiler] " << error << "\n";
+        return 1;
+    }
+    return 0;
+}
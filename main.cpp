@@ -1,21 +1,63 @@
 ﻿#include "game_parameters.hpp"
 #include "game_systems.hpp"
 #include "scenes.hpp"
-#include "run_context.hpp"
+#include "game_session.hpp"
+#include "job_system.hpp"
+#include "trace.hpp"
+
+#include <iostream>
+#include <string>
 
 using param = Parameters;
 
-int main() {
-    // Shared run state for this playthrough (e.g. wave number, player stats)
-    Scenes::runContext = std::make_shared<RunContext>();
+int main(int argc, char** argv) {
+    // --record file: save the run's inputs for tile_engine_headless --replay
+    // --hitch-ms T: flight recorder threshold (0 turns automatic dumps off)
+    // --memory: print the memory footprint and per-wave peaks on exit
+    // --no-governor: never degrade quality when frames run over budget
+    std::string recordPath;
+    float       hitchMs = param::hitch_threshold_ms;
+    bool        memory = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (arg == "--hitch-ms" && i + 1 < argc) {
+            hitchMs = std::stof(argv[++i]);
+        }
+        else if (arg == "--memory") {
+            memory = true;
+        }
+        else if (arg == "--no-governor") {
+            GameSystem::set_governor_enabled(false);
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--record file] [--hitch-ms T] [--memory] [--no-governor]\n";
+            return 1;
+        }
+    }
+
+    // Keep trace spans of the last few seconds so F4 can dump a hitch
+    Trace::set_enabled(true);
+
+    // Worker threads for splitting big sim phases (outlives the session)
+    JobSystem jobs;
 
-    // Core Dusk scenes
-    Scenes::safehouse = std::make_shared<SafehouseScene>();
-    Scenes::tower_defence = std::make_shared<TowerDefenceScene>();
-    Scenes::end = std::make_shared<EndScene>();
+    // One run of the game: level, core Dusk scenes and shared run state
+    // (e.g. wave number, player stats)
+    auto session = std::make_shared<GameSession>();
+    session->set_job_system(&jobs);
+    if (!recordPath.empty()) session->start_recording(param::time_step);
+    session->flight_recorder().set_threshold_ms(hitchMs);
+    session->set_memory_tracking(memory);
 
     // Start the game in the safehouse (later this could be a main menu)
-    GameSystem::set_active_scene(Scenes::safehouse);
+    session->set_active_scene(session->safehouse);
+
+    // Load the TD level in the background so the first swap doesn't hitch
+    session->prewarm(session->tower_defence);
+    GameSystem::set_session(session);
 
     // Kick off the main game loop
     GameSystem::start(
@@ -25,5 +67,17 @@ int main() {
         param::time_step
     );
 
+    if (memory) {
+        // Sim side as of the last step plus what the renderer held
+        MemoryReport last = session->get_memory();
+        last.merge(GameSystem::get_render_memory());
+        std::cout << "\n[memory] footprint at exit:\n" << last.format()
+            << "\n[memory] peak over the run (sim side):\n" << session->get_memory_peak().format()
+            << "\n[memory] peak per wave (live KiB):\n"
+            << MemoryReport::format_waves(session->get_wave_memory_peaks(), WaveManager::kWavesPerLevel);
+    }
+
+    if (!recordPath.empty() && !session->save_recording(recordPath)) return 1;
+
     return 0;
 }
@@ -0,0 +1,117 @@
+// memory_report.cpp
+#include "memory_report.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+std::size_t MemoryReport::total() const {
+    std::size_t bytes = 0;
+    for (const auto& u : _pools) bytes += u.bytes + u.spare;
+    return bytes;
+}
+
+void MemoryReport::keep_max(const MemoryReport& other) {
+    for (std::size_t i = 0; i < kPoolCount; ++i) {
+        _pools[i].bytes = std::max(_pools[i].bytes, other._pools[i].bytes);
+        _pools[i].spare = std::max(_pools[i].spare, other._pools[i].spare);
+        _pools[i].items = std::max(_pools[i].items, other._pools[i].items);
+    }
+}
+
+void MemoryReport::merge(const MemoryReport& other) {
+    for (std::size_t i = 0; i < kPoolCount; ++i) {
+        _pools[i].bytes += other._pools[i].bytes;
+        _pools[i].spare += other._pools[i].spare;
+        _pools[i].items += other._pools[i].items;
+    }
+}
+
+const char* MemoryReport::name(MemPool pool) {
+    switch (pool) {
+    case MemPool::Enemies:      return "enemies";
+    case MemPool::Bullets:      return "bullets";
+    case MemPool::Turrets:      return "turrets";
+    case MemPool::Invaders:     return "invaders";
+    case MemPool::EnemyBullets: return "sh bullets";
+    case MemPool::LevelTiles:   return "level tiles";
+    case MemPool::LevelMesh:    return "level mesh";
+    case MemPool::Fonts:        return "fonts";
+    case MemPool::HudText:      return "hud text";
+    case MemPool::Count:        break;
+    }
+    return "?";
+}
+
+std::string MemoryReport::format_waves(const std::vector<MemoryReport>& waves, int wavesPerLevel) {
+    std::string text;
+    char line[256];
+    int  n = 0;
+
+    // Only pools that had something live in some wave, each column as
+    // wide as its name
+    std::array<int, kPoolCount> width{};
+    for (const auto& r : waves) {
+        for (std::size_t i = 0; i < kPoolCount; ++i) {
+            if (r._pools[i].bytes > 0) {
+                width[i] = std::max(8, static_cast<int>(std::strlen(name(static_cast<MemPool>(i)))));
+            }
+        }
+    }
+
+    n = std::snprintf(line, sizeof(line), "%-7s", "");
+    for (std::size_t i = 0; i < kPoolCount; ++i) {
+        if (width[i] == 0) continue;
+        n += std::snprintf(line + n, sizeof(line) - n, " %*s", width[i], name(static_cast<MemPool>(i)));
+    }
+    std::snprintf(line + n, sizeof(line) - n, " %8s\n", "total");
+    text += line;
+
+    for (std::size_t w = 0; w < waves.size(); ++w) {
+        const MemoryReport& r = waves[w];
+        if (r.total() == 0) continue;
+
+        n = std::snprintf(line, sizeof(line), "L%d W%-3d",
+            static_cast<int>(w) / wavesPerLevel + 1, static_cast<int>(w) % wavesPerLevel + 1);
+        for (std::size_t i = 0; i < kPoolCount; ++i) {
+            if (width[i] == 0) continue;
+            n += std::snprintf(line + n, sizeof(line) - n, " %*.1f", width[i], r._pools[i].bytes / 1024.0);
+        }
+        std::snprintf(line + n, sizeof(line) - n, " %8.1f\n", r.total() / 1024.0);
+        text += line;
+    }
+    return text;
+}
+
+std::string MemoryReport::format() const {
+    std::string text;
+    char line[96];
+
+    std::snprintf(line, sizeof(line), "%-13s %9s %9s %7s %7s\n",
+        "", "live KiB", "spare KiB", "items", "B/item");
+    text += line;
+
+    std::size_t live = 0;
+    for (std::size_t i = 0; i < kPoolCount; ++i) {
+        const MemUsage& u = _pools[i];
+        live += u.bytes;
+        if (u.bytes == 0 && u.spare == 0) continue;
+
+        // Per-item cost only means something for pools of items
+        if (u.items > 0) {
+            std::snprintf(line, sizeof(line), "%-13s %9.1f %9.1f %7zu %7zu\n",
+                name(static_cast<MemPool>(i)), u.bytes / 1024.0, u.spare / 1024.0,
+                u.items, u.bytes / u.items);
+        }
+        else {
+            std::snprintf(line, sizeof(line), "%-13s %9.1f %9.1f\n",
+                name(static_cast<MemPool>(i)), u.bytes / 1024.0, u.spare / 1024.0);
+        }
+        text += line;
+    }
+
+    std::snprintf(line, sizeof(line), "%-13s %9.1f %9.1f\n",
+        "total", live / 1024.0, (total() - live) / 1024.0);
+    text += line;
+    return text;
+}
@@ -0,0 +1,135 @@
+// memory_report.hpp
+#pragma once
+// Memory footprint per subsystem: how many bytes the live enemies,
+// bullets, turrets, invaders, level, fonts and HUD text hold right now,
+// and how many items that is.
+//
+// Live bytes are the elements in use plus the heap each one owns; what a
+// container has reserved past its size is kept apart as spare, so
+// bytes / items is the real cost of one more item. SFML shapes keep their
+// vertices in vectors of their own; those are worked out from the point
+// count the same way sf::Shape::update() sizes them. Allocator overhead
+// isn't counted, so read the numbers as a lower bound that shows growth
+// and regressions, not as an exact heap total.
+//
+// Filling a report walks every entity, so it only happens when asked for
+// (GameSession::set_memory_tracking, tile_engine_headless --memory).
+
+#include <SFML/Graphics/Shape.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class MemPool {
+    Enemies,        // TD enemies + per-step enemy results
+    Bullets,        // TD bullets
+    Turrets,        // TD turrets + per-step shot results
+    Invaders,       // Safehouse invaders + escaped enemy buffer
+    EnemyBullets,   // Safehouse enemy bullets
+    LevelTiles,     // tile grids, colour tables, enemy paths
+    LevelMesh,      // tile quads (4 vertices per tile)
+    Fonts,          // glyph pages of the sizes drawn so far
+    HudText,        // HUD strings and drawn text geometry
+
+    Count
+};
+
+struct MemUsage {
+    std::size_t bytes = 0;   // live items and the heap they own
+    std::size_t spare = 0;   // reserved but unused container capacity
+    std::size_t items = 0;
+};
+
+class MemoryReport {
+public:
+    static constexpr std::size_t kPoolCount = static_cast<std::size_t>(MemPool::Count);
+
+    void add(MemPool pool, std::size_t bytes, std::size_t items = 0) {
+        MemUsage& u = _pools[index(pool)];
+        u.bytes += bytes;
+        u.items += items;
+    }
+
+    // The elements of `v` (items and live bytes) and its unused capacity.
+    // Heap the elements own is added separately with add().
+    template <typename T>
+    void add_vector(MemPool pool, const std::vector<T>& v) {
+        MemUsage& u = _pools[index(pool)];
+        u.bytes += v.size() * sizeof(T);
+        u.spare += (v.capacity() - v.size()) * sizeof(T);
+        u.items += v.size();
+    }
+
+    // Same for a scratch / helper vector whose elements aren't items
+    template <typename T>
+    void add_buffer(MemPool pool, const std::vector<T>& v) {
+        MemUsage& u = _pools[index(pool)];
+        u.bytes += v.size() * sizeof(T);
+        u.spare += (v.capacity() - v.size()) * sizeof(T);
+    }
+
+    // Reserved bytes with nothing in them yet
+    void add_spare(MemPool pool, std::size_t bytes) { _pools[index(pool)].spare += bytes; }
+
+    const MemUsage& get(MemPool pool) const { return _pools[index(pool)]; }
+    std::size_t     total() const;   // live + spare, every pool
+
+    void clear() { _pools = {}; }
+
+    // Keep the higher of each pool's numbers (each field separately),
+    // for high-water marks
+    void keep_max(const MemoryReport& other);
+
+    // Fold in another report (e.g. render side into sim side)
+    void merge(const MemoryReport& other);
+
+    static const char* name(MemPool pool);
+
+    // One line per pool with anything in it, plus the total
+    std::string format() const;
+
+    // One line per wave with anything recorded: live KiB per pool and the
+    // total (spare included). `waves` is indexed level * wavesPerLevel +
+    // wave, like GameSession::get_wave_memory_peaks().
+    static std::string format_waves(const std::vector<MemoryReport>& waves, int wavesPerLevel);
+
+private:
+    static std::size_t index(MemPool pool) { return static_cast<std::size_t>(pool); }
+
+    std::array<MemUsage, kPoolCount> _pools{};
+};
+
+// Heap held by common containers / SFML objects, not counting the object
+// itself (that is already in its owner's size)
+namespace MemSize {
+
+// Short strings live inside the object (SSO) and cost nothing extra
+inline std::size_t string(const std::string& s) {
+    const char* data = s.data();
+    const char* self = reinterpret_cast<const char*>(&s);
+    if (data >= self && data < self + sizeof(s)) return 0;
+    return s.capacity() + 1;
+}
+
+// Fill: points + 2 (centre + closing point); outline: two per point
+// plus the closing pair, only built when there is a thickness
+inline std::size_t shape(const sf::Shape& s) {
+    const std::size_t points = s.getPointCount();
+    std::size_t vertices = points + 2;
+    if (s.getOutlineThickness() != 0.f) vertices += (points + 1) * 2;
+    return vertices * sizeof(sf::Vertex);
+}
+
+// Two triangles per glyph, plus the UTF-32 copy of the string
+inline std::size_t text(const sf::Text& t) {
+    const std::size_t glyphs = t.getString().getSize();
+    std::size_t vertices = glyphs * 6;
+    if (t.getOutlineThickness() != 0.f) vertices *= 2;
+    return vertices * sizeof(sf::Vertex) + (glyphs + 1) * sizeof(sf::Uint32);
+}
+
+} // namespace MemSize
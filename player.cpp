@@ -1,17 +1,20 @@
 #include "player.hpp"
 #include "tile_level_loader/level_system.hpp"
 #include "game_parameters.hpp"
+#include "frame_snapshot.hpp"
+#include "input.hpp"
 
-#include <SFML/Window/Keyboard.hpp>
 #include <SFML/Graphics/CircleShape.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 using ls = LevelSystem;
 using param = Parameters;
 
-Player::Player()
-    : Entity(std::make_unique<sf::CircleShape>(kRadius)) {
+Player::Player(const Input& input)
+    : Entity(std::make_unique<sf::CircleShape>(kRadius))
+    , _input(input) {
 
     // Base colour for the player
     _baseColor = sf::Color::Magenta;
@@ -21,21 +24,18 @@ Player::Player()
     _shape->setOrigin({ kRadius, kRadius });
 
     // Default start position (overwritten by scenes)
-    set_position({ 100.f, 100.f });
+    teleport({ 100.f, 100.f });
 }
 
 void Player::update(const float& dt) {
     sf::Vector2f dir{ 0.f, 0.f };
 
-    // Basic WASD / Arrow movement input
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::A) ||
-        sf::Keyboard::isKeyPressed(sf::Keyboard::Left))  dir.x -= 1.f;
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::D) ||
-        sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) dir.x += 1.f;
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::W) ||
-        sf::Keyboard::isKeyPressed(sf::Keyboard::Up))    dir.y -= 1.f;
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::S) ||
-        sf::Keyboard::isKeyPressed(sf::Keyboard::Down))  dir.y += 1.f;
+    // Basic WASD / Arrow movement input (sim-side input snapshot)
+    const Input& in = _input;
+    if (in.held(sf::Keyboard::A) || in.held(sf::Keyboard::Left))  dir.x -= 1.f;
+    if (in.held(sf::Keyboard::D) || in.held(sf::Keyboard::Right)) dir.x += 1.f;
+    if (in.held(sf::Keyboard::W) || in.held(sf::Keyboard::Up))    dir.y -= 1.f;
+    if (in.held(sf::Keyboard::S) || in.held(sf::Keyboard::Down))  dir.y += 1.f;
 
     if (dir.x != 0.f || dir.y != 0.f) {
         // Normalise direction so diagonal speed isnt faster
@@ -44,23 +44,15 @@ void Player::update(const float& dt) {
 
         const sf::Vector2f target = get_position() + norm * kSpeed * dt;
 
-        if (!_use_tile_collision) {
+        if (!_level) {
             // Safehouse: free movement
             set_position(target);
         }
         else {
-            // Maze / Tower Defence: respect level collision
-            try {
-                const auto tile = ls::get_tile_at(target);
-
-                if (tile != ls::WALL &&
-                    tile != ls::WAYPOINT &&   // enemy lane
-                    tile != ls::ENEMY) {      // reserved tile type
-                    set_position(target);
-                }
-            }
-            catch (...) {
-                // If level system fails (out of bounds etc.), just allow movement
+            // Maze / Tower Defence: respect level collision. Off the
+            // level (no tile) movement is allowed.
+            const auto grid = _level->find_grid_at(target);
+            if (!grid || _level->has_flags(*grid, ls::WALKABLE)) {
                 set_position(target);
             }
         }
@@ -79,13 +71,21 @@ void Player::update(const float& dt) {
         _shape->setFillColor(_baseColor);
     }
 
-    // Clamp player inside the game window
+    // Clamp player inside the game window, or the level if it's bigger
+    // (the camera scrolls over it)
     sf::Vector2f pos = get_position();
 
+    sf::Vector2f bounds(static_cast<float>(param::game_width), static_cast<float>(param::game_height));
+    if (_level) {
+        const sf::Vector2f world = _level->get_world_size();
+        bounds.x = std::max(bounds.x, world.x);
+        bounds.y = std::max(bounds.y, world.y);
+    }
+
     const float minX = kRadius;
-    const float maxX = static_cast<float>(param::game_width) - kRadius;
+    const float maxX = bounds.x - kRadius;
     const float minY = kRadius;
-    const float maxY = static_cast<float>(param::game_height) - kRadius;
+    const float maxY = bounds.y - kRadius;
 
     pos.x = std::clamp(pos.x, minX, maxX);
     pos.y = std::clamp(pos.y, minY, maxY);
@@ -96,8 +96,9 @@ void Player::update(const float& dt) {
     Entity::update(dt);
 }
 
-void Player::render(sf::RenderWindow& window) const {
-    window.draw(*_shape);
+void Player::publish(FrameSnapshot& out) const {
+    // Renderer interpolates between the last two sim steps
+    out.add_circle(_prev_position, _position, kRadius, _shape->getFillColor());
 }
 
 void Player::take_damage(int amount) {
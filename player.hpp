@@ -3,20 +3,24 @@
 #include "entity.hpp"
 #include <SFML/Graphics.hpp>
 
+class Input;
+class LevelSystem;
+
 // Simple player controlled circle
 class Player : public Entity {
 public:
-    Player();
+    // Movement follows `input` (the owning session's sim-side input)
+    explicit Player(const Input& input);
 
     // Perframe logic (input, movement, flash, clamping)
     void update(const float& dt) override;
 
-    // Draw the player to the window
-    void render(sf::RenderWindow& window) const override;
+    // Add the player to the frame snapshot
+    void publish(FrameSnapshot& out) const override;
 
-    // Turn tile-based collision on/off
-    // (true in Maze / Tower Defence, false in Safehouse)
-    void set_use_tile_collision(bool enabled) { _use_tile_collision = enabled; }
+    // Collide against this level's tiles (Maze / Tower Defence),
+    // or nullptr for free movement (Safehouse)
+    void set_tile_collision(const LevelSystem* level) { _level = level; }
 
     // --- Health API ---
     int  get_health() const { return _health; }
@@ -33,7 +37,8 @@ private:
     static constexpr float kRadius = 25.f;       // visual + collision radius
     static constexpr float kSpeed = 200.f;      // movement speed (units/sec)
 
-    bool _use_tile_collision = false;            // if true, respect level tiles
+    const Input&       _input;                   // held movement keys
+    const LevelSystem* _level = nullptr;         // if set, respect its tiles
 
     // Health
     int _maxHealth = 5;
@@ -0,0 +1,155 @@
+// replay.cpp
+#include "replay.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace {
+// `>>` into an unsigned type happily wraps "-1" round to a huge value;
+// these fields are never negative, so a sign is a parse error
+template <typename T>
+bool read_unsigned(std::istream& in, T& out) {
+    in >> std::ws;
+    if (in.peek() == '-' || in.peek() == '+') return false;
+    return static_cast<bool>(in >> out);
+}
+}
+
+void Replay::clear() {
+    seed = 0;
+    step = 0.f;
+    ticks = 0;
+    events.clear();
+}
+
+bool Replay::save(const std::string& path) const {
+    std::ofstream f(path);
+    if (!f.good()) {
+        std::cerr << "[Replay] Couldn't open " << path << " for writing\n";
+        return false;
+    }
+
+    // Enough digits for floats to read back bit-exact
+    f << std::setprecision(std::numeric_limits<float>::max_digits10);
+    f << "dusk-replay " << kVersion << "\n"
+        << "seed " << seed << "\n"
+        << "step " << step << "\n"
+        << "ticks " << ticks << "\n";
+
+    for (const auto& e : events) {
+        f << e.tick;
+        if (e.kind == ReplayEvent::Kind::SceneSwitch) {
+            f << " scene " << e.scene << "\n";
+            continue;
+        }
+
+        const SimCommand& cmd = e.command;
+        if (cmd.type == SimCommandType::InputState) {
+            // Only held state and the mouse reach the sim
+            f << " input " << cmd.input.mouseWorld.x << " " << cmd.input.mouseWorld.y;
+            for (std::size_t bit = 0; bit < cmd.input.held.size(); ++bit) {
+                if (cmd.input.held[bit]) f << " " << bit;
+            }
+            f << "\n";
+        }
+        else {
+            f << " cmd " << static_cast<int>(cmd.type)
+                << " " << cmd.aim.x << " " << cmd.aim.y << " " << cmd.value << "\n";
+        }
+    }
+
+    if (!f.good()) {
+        std::cerr << "[Replay] Failed writing " << path << "\n";
+        return false;
+    }
+    std::cout << "[Replay] Saved " << events.size() << " events over "
+        << ticks << " ticks to " << path << "\n";
+    return true;
+}
+
+bool Replay::load(const std::string& path) {
+    clear();
+
+    std::ifstream f(path);
+    if (!f.good()) {
+        std::cerr << "[Replay] Couldn't open " << path << "\n";
+        return false;
+    }
+
+    std::string magic;
+    int version = 0;
+    if (!(f >> magic >> version) || magic != "dusk-replay" || version != kVersion) {
+        std::cerr << "[Replay] " << path << " is not a version " << kVersion << " replay\n";
+        return false;
+    }
+
+    std::string line;
+    std::getline(f, line); // rest of the header line
+    int lineNo = 1;
+    while (std::getline(f, line)) {
+        ++lineNo;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream ss(line);
+        std::string first;
+        ss >> first;
+
+        bool ok = true;
+        if (first == "seed")       ok = read_unsigned(ss, seed);
+        else if (first == "step")  ok = static_cast<bool>(ss >> step);
+        else if (first == "ticks") ok = read_unsigned(ss, ticks);
+        else {
+            ReplayEvent e;
+            std::string kind;
+            std::istringstream tickText(first);
+            ok = read_unsigned(tickText, e.tick) && (tickText >> std::ws).eof() &&
+                static_cast<bool>(ss >> kind);
+
+            if (ok && kind == "scene") {
+                e.kind = ReplayEvent::Kind::SceneSwitch;
+                ok = static_cast<bool>(ss >> e.scene);
+            }
+            else if (ok && kind == "input") {
+                e.command.type = SimCommandType::InputState;
+                ok = static_cast<bool>(ss >> e.command.input.mouseWorld.x >> e.command.input.mouseWorld.y);
+                std::size_t bit = 0;
+                while (ok && !(ss >> std::ws).eof()) {
+                    ok = read_unsigned(ss, bit) && bit < e.command.input.held.size();
+                    if (ok) e.command.input.held.set(bit);
+                }
+            }
+            else if (ok && kind == "cmd") {
+                int type = 0;
+                // InputState carries the input payload: only valid as an
+                // "input" line
+                ok = static_cast<bool>(ss >> type >> e.command.aim.x >> e.command.aim.y >> e.command.value) &&
+                    type >= 0 && type <= static_cast<int>(SimCommandType::SetQuality) &&
+                    type != static_cast<int>(SimCommandType::InputState);
+                e.command.type = static_cast<SimCommandType>(type);
+            }
+            else {
+                ok = false;
+            }
+
+            // Header lines come first, so the run length is known here
+            // (commands handled after the last step carry tick == ticks)
+            ok = ok && e.tick <= ticks;
+
+            if (ok) events.push_back(e);
+        }
+
+        if (!ok) {
+            std::cerr << "[Replay] " << path << ":" << lineNo << ": can't parse \"" << line << "\"\n";
+            return false;
+        }
+    }
+
+    if (step <= 0.f) {
+        std::cerr << "[Replay] " << path << " has no step size\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+// replay.hpp
+#pragma once
+// A recorded run: the seed, the step size and every player command in the
+// tick it was applied, which is everything a GameSession needs to re-run
+// the same game step for step (tile_engine_headless --replay).
+//
+// Scene switches that depend on loader-thread timing (a requested scene
+// becoming ready) are recorded too, and played back at the same tick.
+//
+// Saved as text, one record per line:
+//   dusk-replay 1
+//   seed <n>
+//   step <seconds>
+//   ticks <n>
+//   <tick> input <mouseX> <mouseY> [<bit> ...]     held keys / buttons
+//   <tick> cmd <SimCommandType> <aimX> <aimY> <value>
+//   <tick> scene <index>                            0 safehouse, 1 TD, 2 end
+//
+// load() rejects signs on ticks, seeds and key bits, events past `ticks`
+// (so the header comes first) and InputState written as a plain cmd.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sim_command.hpp"
+
+struct ReplayEvent {
+    enum class Kind : unsigned char { Command, SceneSwitch };
+
+    std::uint64_t tick = 0;
+    Kind          kind = Kind::Command;
+    SimCommand    command;     // Command
+    int           scene = 0;   // SceneSwitch (GameSession::scene_index)
+};
+
+class Replay {
+public:
+    static constexpr int kVersion = 1;
+
+    unsigned int             seed = 0;
+    float                    step = 0.f;
+    std::uint64_t            ticks = 0;     // length of the recorded run
+    std::vector<ReplayEvent> events;        // in the order they were applied
+
+    void clear();
+
+    // Both print the reason and return false on failure
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
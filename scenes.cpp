@@ -4,93 +4,56 @@
 #include "game_parameters.hpp"
 #include "TDEnemy.hpp"
 #include "EnemyStats.hpp"
+#include "job_system.hpp"
+#include "trace.hpp"
+#include "alloc_tracker.hpp"
+#include "state_hash.hpp"
+#include "memory_report.hpp"
+#include "frame_governor.hpp"
 
 
-#include <SFML/Window/Keyboard.hpp>
-#include <SFML/Window/Mouse.hpp>
-
-#include <unordered_map>
 #include <iostream>
+#include <chrono>
 #include <cmath>
 #include <algorithm>
+#include <cstdio>
 
 using ls = LevelSystem;
 using param = Parameters;
 
-// ------------------------------------------------------------
-// Global scene handles (defined here, declared in scenes.hpp)
-// ------------------------------------------------------------
-std::shared_ptr<Scene>      Scenes::safehouse = nullptr;
-std::shared_ptr<Scene>      Scenes::tower_defence = nullptr;
-std::shared_ptr<Scene>      Scenes::end = nullptr;
-std::shared_ptr<RunContext> Scenes::runContext = nullptr;
-
-// ---------------------------------------------------------------------
-// Key edge-trigger helper
-//  - Returns true only on the exact frame the key goes from up -> down
-//  - Used for actions like placing turrets and swapping scenes
-// ---------------------------------------------------------------------
-bool keyPressedOnce(sf::Keyboard::Key key) {
-    static std::unordered_map<sf::Keyboard::Key, bool> keyStates;
-
-    bool isPressed = sf::Keyboard::isKeyPressed(key);
-    bool wasPressed = keyStates[key];
-
-    keyStates[key] = isPressed;
-
-    return (isPressed && !wasPressed);
+// HUD text is refreshed every step. Formatting into the existing string
+// reuses its capacity, so this doesn't allocate once the text has grown.
+static void format_wave_text(std::string& out, int level, int wave, int waves,
+    const char* suffix)
+{
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "Level %d - Wave %d/%d%s", level, wave, waves, suffix);
+    out.assign(buf);
 }
 
-
 // ============================================================================
 // SafehouseScene (roguelite side)
 // ============================================================================
 void SafehouseScene::load() {
-    _background.setSize({
-        static_cast<float>(param::game_width),
-        static_cast<float>(param::game_height)
-        });
-    _background.setFillColor(sf::Color(30, 15, 15));
-
-    // UI font 
-    if (!_font.loadFromFile("res/fonts/ARIAL.TTF")) {
-        std::cerr << "Failed to load font: res/fonts/ARIAL.TTF\n";
-    }
-
-    _label.setFont(_font);
-    _label.setString("SAFEHOUSE");
-    _label.setCharacterSize(32);
-    _label.setFillColor(sf::Color::White);
-    _label.setPosition(20.f, 20.f);
-
-	//Player HP text
-    _hpText.setFont(_font);
-    _hpText.setCharacterSize(24);
-    _hpText.setFillColor(sf::Color::White);
-    _hpText.setPosition(20.f, 60.f);   // a bit below the title
-    _hpText.setString("HP: 0/0");
-
-    // NEW: Wave / level text
-    _waveText.setFont(_font);
-    _waveText.setCharacterSize(24);
-    _waveText.setFillColor(sf::Color::White);
-    _waveText.setPosition(20.f, 90.f);   // just below HP text
-    _waveText.setString("Level 1 - Wave 1/5");
-
-	// Make the attack arc shape
-    _attackArcShape.setPointCount(3);
-    _attackArcShape.setFillColor(sf::Color(255, 255, 255, 60));
+    // HUD placeholders until the first update fills them in
+    _hpText = "HP: 0/0";
+    _waveText = "Level 1 - Wave 1/5";
 
     // First time only: create the player
     if (!_initialised) {
-        _player = std::make_shared<Player>();
-        _player->set_use_tile_collision(false); // Safehouse ignores tiles
+        _player = std::make_shared<Player>(_session.input());
+        _player->set_tile_collision(nullptr); // Safehouse ignores tiles
 
-        _player->set_position({
+        _player->teleport({
             param::game_width * 0.5f,
             param::game_height * 0.5f
             });
 
+        // Room for a busy run, so steps don't grow these
+        _invaders.reserve(kReserveInvaders);
+        _enemyBullets.reserve(kReserveEnemyBullets);
+        _escapedBuffer.reserve(TowerDefenceScene::kEscapeQueueSize);
+
         _initialised = true;
     }
 
@@ -102,9 +65,15 @@ void SafehouseScene::load() {
 }
 
 void SafehouseScene::tick_simulation(float dt) {
+    TRACE_SCOPE("SH::tick_simulation");
+    ALLOC_SCOPE(Safehouse);
+
     // If we’ve never been loaded / initialised, nothing to do
     if (!_initialised || !_player) return;
 
+    // Pick up anything that escaped TD since our last tick
+    pull_escaped_enemies();
+
     // Cooldown for contact damage still counts down
     if (_damageCooldown > 0.f) {
         _damageCooldown -= dt;
@@ -115,19 +84,77 @@ void SafehouseScene::tick_simulation(float dt) {
     update_invaders(dt);
 
 	update_enemy_bullets(dt); //keep enemy bullets updating too
-    // Optional: if player can die off-screen, keep this
+
+    // Player can die off-screen; the caller switches to the end scene
+    // once it's back on the main thread (see is_player_dead()).
     if (_player->is_dead()) {
         _invaders.clear();
+    }
+}
 
-        if (!Scenes::end) {
-            Scenes::end = std::make_shared<EndScene>();
-        }
 
-        GameSystem::set_active_scene(Scenes::end);
+// Drain TD's escape queue and turn each escaped enemy into an invader
+void SafehouseScene::pull_escaped_enemies() {
+    auto* td = static_cast<TowerDefenceScene*>(_session.tower_defence.get());
+    if (!td) return;
+
+    _escapedBuffer.clear();
+    td->drain_escaped_enemies(_escapedBuffer);
+    if (!_escapedBuffer.empty()) {
+        spawn_invaders(_escapedBuffer);
     }
 }
 
 
+void SafehouseScene::count_live(size_t& entities, size_t& bullets) const {
+    entities += _entities.size() + _invaders.size() + _enemyBullets.size();
+    bullets += _enemyBullets.size();
+}
+
+void SafehouseScene::hash_state(StateHash& h) const {
+    Scene::hash_state(h);
+    h.add(get_player_health());
+
+    h.add(static_cast<std::uint64_t>(_invaders.size()));
+    for (const auto& inv : _invaders) {
+        h.add(static_cast<int>(inv.type));
+        h.add(inv.shape.getPosition());
+        h.add(inv.hp);
+        h.add(inv.flashTimer);
+        h.add(inv.shootCooldown);
+    }
+
+    h.add(static_cast<std::uint64_t>(_enemyBullets.size()));
+    for (const auto& b : _enemyBullets) {
+        h.add(b.shape.getPosition());
+        h.add(b.vel);
+        h.add(b.ttl);
+    }
+
+    h.add(_attackCooldown);
+    h.add(_damageCooldown);
+}
+
+void SafehouseScene::report_memory(MemoryReport& out) const {
+    out.add_vector(MemPool::Invaders, _invaders);
+    for (const auto& inv : _invaders) out.add(MemPool::Invaders, MemSize::shape(inv.shape));
+    out.add_buffer(MemPool::Invaders, _escapedBuffer);
+
+    out.add_vector(MemPool::EnemyBullets, _enemyBullets);
+    for (const auto& b : _enemyBullets) out.add(MemPool::EnemyBullets, MemSize::shape(b.shape));
+
+    out.add(MemPool::HudText, MemSize::string(_hpText) + MemSize::string(_waveText));
+}
+
+bool SafehouseScene::is_player_dead() const {
+    return _player && _player->is_dead();
+}
+
+int SafehouseScene::get_player_health() const {
+    return _player ? _player->get_health() : 0;
+}
+
+
 void SafehouseScene::spawn_invaders(const std::vector<int>& enemyTypes) {
     for (int typeId : enemyTypes) {
         Invader inv;
@@ -165,6 +192,7 @@ void SafehouseScene::spawn_invaders(const std::vector<int>& enemyTypes) {
         }
 
         inv.shape.setPosition(x, y);
+        inv.prevPos = inv.shape.getPosition();
 
         _invaders.push_back(inv);
     }
@@ -173,13 +201,18 @@ void SafehouseScene::spawn_invaders(const std::vector<int>& enemyTypes) {
 
 // Move invaders towards the player, handle contact damage and hit flash
 void SafehouseScene::update_invaders(float dt) {
+    TRACE_SCOPE("SH::update_invaders");
+    ALLOC_SCOPE(Safehouse);
+    ScopedStatTimer timer(_session.get_stats(), Stat::UpdateInvaders);
     if (_invaders.empty() || !_player) return;
 
     sf::Vector2f playerPos = _player->get_position();
     float        playerR = _player->get_radius();
+    const bool   flash = FrameGovernor::hit_flash(_session.get_quality());
 
     for (auto& inv : _invaders) {
         sf::Vector2f pos = inv.shape.getPosition();
+        inv.prevPos = pos; // start-of-step position for interpolation
         sf::Vector2f dir = playerPos - pos;
 
         float lenSq = dir.x * dir.x + dir.y * dir.y;
@@ -225,6 +258,7 @@ void SafehouseScene::update_invaders(float dt) {
                 b.shape.setOrigin(4.f, 4.f);
                 b.shape.setFillColor(inv.baseColor);
                 b.shape.setPosition(pos);
+                b.prevPos = pos;
 
                 sf::Vector2f shotDir = dir / len; // already have len from above
                 b.vel = shotDir;
@@ -252,9 +286,9 @@ void SafehouseScene::update_invaders(float dt) {
         }
 
         // ------------------------
-        // Hit flash 
+        // Hit flash (colour only when it changes, and not under load)
         // ------------------------
-        if (inv.flashTimer > 0.f) {
+        if (inv.flashTimer > 0.f && flash) {
             inv.flashTimer -= dt;
             float t = std::max(inv.flashTimer / 0.15f, 0.f);
 
@@ -272,28 +306,33 @@ void SafehouseScene::update_invaders(float dt) {
             inv.shape.setFillColor(c);
         }
         else {
-            inv.shape.setFillColor(inv.baseColor);
+            if (inv.flashTimer > 0.f) inv.flashTimer -= dt;
+            if (inv.shape.getFillColor() != inv.baseColor) inv.shape.setFillColor(inv.baseColor);
         }
     }
 }
 
 
 void SafehouseScene::update_enemy_bullets(float dt) {
+    TRACE_SCOPE("SH::update_enemy_bullets");
+    ALLOC_SCOPE(Safehouse);
+    ScopedStatTimer timer(_session.get_stats(), Stat::UpdateEnemyBullets);
     if (_enemyBullets.empty() || !_player) return;
 
-    std::vector<EnemyBullet> alive;
-    alive.reserve(_enemyBullets.size());
-
     sf::Vector2f playerPos = _player->get_position();
     float        playerR = _player->get_radius();
 
-    for (auto& b : _enemyBullets) {
+    // Survivors are packed to the front in order, in place
+    size_t kept = 0;
+    for (size_t i = 0; i < _enemyBullets.size(); ++i) {
+        EnemyBullet& b = _enemyBullets[i];
         b.ttl -= dt;
         if (b.ttl <= 0.f) {
             continue; // bullet expired
         }
 
         // Move bullet
+        b.prevPos = b.shape.getPosition();
         b.shape.move(b.vel * b.speed * dt);
 
         // Check collision with player
@@ -313,128 +352,133 @@ void SafehouseScene::update_enemy_bullets(float dt) {
         }
 
         if (!hitPlayer) {
-            alive.push_back(b);
+            if (kept != i) _enemyBullets[kept] = std::move(b);
+            ++kept;
         }
     }
 
-    _enemyBullets.swap(alive);
+    _enemyBullets.erase(_enemyBullets.begin() + static_cast<std::ptrdiff_t>(kept),
+        _enemyBullets.end());
 }
 
 
 void SafehouseScene::update(const float& dt) {
+    // TD simulation continues in the background on the sim worker thread,
+    // in parallel with the Safehouse update below, at a reduced rate unless
+    // something is happening there. Nothing here may read TD state until
+    // the worker is waited on; escaped enemies reach us through TD's escape
+    // queue instead.
+    SimWorker& backgroundSim = _session.background_sim();
+    SimLod&    backgroundLod = _session.background_lod();
+    auto* td = static_cast<TowerDefenceScene*>(_session.tower_defence.get());
+    float bgDt = 0.f;
+    const int bgTicks = td ? backgroundLod.schedule(td, dt, bgDt) : 0;
+    if (bgTicks > 0) {
+        backgroundSim.run([td, bgTicks, bgDt] {
+            for (int i = 0; i < bgTicks; ++i) td->tick_simulation(bgDt);
+            });
+    }
+
     // Update player entity (movement etc.)
     Scene::update(dt);
 
-    // TD simulation continues in the background
-    if (Scenes::tower_defence) {
-        auto td = std::static_pointer_cast<TowerDefenceScene>(Scenes::tower_defence);
-        td->tick_simulation(dt);
+    // Spawn any enemy types that escaped TD as invaders here
+    pull_escaped_enemies();
 
-        // Pull escaped enemy types and spawn them as invaders here
-        auto escapedTypes = td->consume_escaped_enemies();
-        if (!escapedTypes.empty()) {
-            spawn_invaders(escapedTypes);
-        }
+    // --- Attack + damage timers ---
+    if (_attackCooldown > 0.f)    _attackCooldown -= dt;
+    if (_attackEffectTimer > 0.f) _attackEffectTimer -= dt;
+    if (_damageCooldown > 0.f)    _damageCooldown -= dt;
+
+    // --- Update invaders and their bullets ---
+    update_invaders(dt);
+    update_enemy_bullets(dt);
+
+    // TD tick must be finished before we read its wave state below
+    backgroundSim.wait();
+    if (td) td->flush_escaped_enemies();
+
+    // Enemies escaping means TD matters right now: back to full rate
+    if (td && td->get_escaped_total() != _seenEscapes) {
+        _seenEscapes = td->get_escaped_total();
+        backgroundLod.wake();
     }
 
+    // HUD text, every step unless the frame governor has slowed it down
+    const bool refreshHud = FrameGovernor::refresh_hud(_session.get_quality(), _session.get_tick());
+
     // --- Update HP text from player health ---
-    if (_player) {
+    if (_player && refreshHud) {
         int hp = _player->get_health();
         int maxHp = _player->get_max_health();
 
-        _hpText.setString(
-            "HP: " + std::to_string(hp) + "/" + std::to_string(maxHp)
-        );
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "HP: %d/%d", hp, maxHp);
+        _hpText.assign(buf);
     }
 
     // --- Wave / Level UI (TowerDefenceScene) ---
-    if (Scenes::tower_defence) {
-        auto td = std::static_pointer_cast<TowerDefenceScene>(Scenes::tower_defence);
-
+    if (td && refreshHud) {
         if (!td->hasFinishedAllWaves()) {
             int levelIdx = td->getCurrentLevelIndex() + 1; // 0-based -> 1-based
             int waveIdx = td->getCurrentWaveIndex() + 1;
             int totalWaves = td->getWavesInCurrentLevel();
 
-            std::string extra;
-            if (td->isWaitingForPlayer()) {
-                extra = "  (Press E in TD to start)";
-            }
-
-            _waveText.setString(
-                "Level " + std::to_string(levelIdx) +
-                " - Wave " + std::to_string(waveIdx) +
-                "/" + std::to_string(totalWaves) +
-                extra
-            );
+            format_wave_text(_waveText, levelIdx, waveIdx, totalWaves,
+                td->isWaitingForPlayer() ? "  (Press E in TD to start)" : "");
         }
         else {
-            _waveText.setString("All waves complete");
+            _waveText.assign("All waves complete");
         }
+    }
 
-        // --- Debug / testing: spawn specific invader types with number keys ---
-        auto spawnTestEnemy = [this](EnemyType type)
-            {
-                std::vector<int> v;
-                v.push_back(static_cast<int>(type));
-                spawn_invaders(v);
-            };
+    // --- Death check ---
+    if (_player && _player->is_dead()) {
+        _invaders.clear();
+        _session.set_active_scene(_session.end);
+        return;
+    }
 
-        if (keyPressedOnce(sf::Keyboard::Num1)) {
-            spawnTestEnemy(EnemyType::Basic);
-        }
-        if (keyPressedOnce(sf::Keyboard::Num2)) {
-            spawnTestEnemy(EnemyType::Fast);
-        }
-        if (keyPressedOnce(sf::Keyboard::Num3)) {
-            spawnTestEnemy(EnemyType::Tank);
-        }
-        if (keyPressedOnce(sf::Keyboard::Num4)) {
-            spawnTestEnemy(EnemyType::shortRanged);
-        }
-        if (keyPressedOnce(sf::Keyboard::Num5)) {
-            spawnTestEnemy(EnemyType::Exploder);
-        }
-        if (keyPressedOnce(sf::Keyboard::Num6)) {
-            spawnTestEnemy(EnemyType::Medium);
-        }
-        if (keyPressedOnce(sf::Keyboard::Num7)) {
-            spawnTestEnemy(EnemyType::RangedMelee);
-        }
-        if (keyPressedOnce(sf::Keyboard::Num8)) {
-            spawnTestEnemy(EnemyType::FastExploder);
-        }
-        if (keyPressedOnce(sf::Keyboard::Num9)) {
-            spawnTestEnemy(EnemyType::LongRange);
-        }
+}
 
-    }
 
-    // --- Attack + damage timers ---
-    if (_attackCooldown > 0.f)    _attackCooldown -= dt;
-    if (_attackEffectTimer > 0.f) _attackEffectTimer -= dt;
-    if (_damageCooldown > 0.f)    _damageCooldown -= dt;
+void SafehouseScene::handle_command(const SimCommand& cmd) {
+    switch (cmd.type) {
+    case SimCommandType::MeleeAttack:
+        melee_attack(cmd.aim);
+        break;
 
-    // Melee attack in a 90-degree arc towards the mouse
-    bool doAttack = false;
-    if (_attackCooldown <= 0.f && keyPressedOnce(sf::Keyboard::Space)) {
-        doAttack = true;
-        _attackCooldown = 0.5f;
+    case SimCommandType::SpawnTestEnemy:
+        // Debug / testing: spawn a specific invader type
+        spawn_invaders({ cmd.value });
+        break;
+
+    case SimCommandType::SwapScene:
+        // Swap between Safehouse and Tower Defence using Shift. TD's level
+        // is normally loaded ahead of time; if not, we keep ticking here
+        // until it is.
+        _session.request_scene(_session.tower_defence);
+        break;
+
+    default:
+        break;
     }
+}
 
-    if (doAttack && _player) {
+
+// Melee attack in a 90-degree arc towards `aim` (mouse, world coords)
+void SafehouseScene::melee_attack(const sf::Vector2f& aim) {
+    if (_attackCooldown > 0.f || !_player) return;
+    _attackCooldown = 0.5f;
+
+    {
         const float attackRadius = 80.f;
         const float attackRadiusSq = attackRadius * attackRadius;
         const float cosHalfAngle = 0.70710678f; // cos(45°) = 90° cone
 
         sf::Vector2f center = _player->get_position();
 
-        // Mouse position in world coords
-        sf::RenderWindow& window = GameSystem::get_window();
-        sf::Vector2i mousePix = sf::Mouse::getPosition(window);
-        sf::Vector2f mousePos = window.mapPixelToCoords(mousePix);
-
-        sf::Vector2f toMouse = mousePos - center;
+        sf::Vector2f toMouse = aim - center;
         float        lenSqMouse = toMouse.x * toMouse.x + toMouse.y * toMouse.y;
         sf::Vector2f forward(1.f, 0.f);
 
@@ -510,116 +554,105 @@ void SafehouseScene::update(const float& dt) {
             -forward.x * sinA + forward.y * cosA
         );
 
-        _attackArcShape.setPoint(0, center);
-        _attackArcShape.setPoint(1, center + left * attackRadius);
-        _attackArcShape.setPoint(2, center + right * attackRadius);
+        _attackArc[0] = center;
+        _attackArc[1] = center + left * attackRadius;
+        _attackArc[2] = center + right * attackRadius;
 
         _attackEffectTimer = 0.12f;
     }
-
-    // --- Update invaders and their bullets ---
-    update_invaders(dt);
-    update_enemy_bullets(dt);
-
-    // --- Death check ---
-    if (_player && _player->is_dead()) {
-        _invaders.clear();
-
-        if (!Scenes::end) {
-            Scenes::end = std::make_shared<EndScene>();
-        }
-
-        GameSystem::set_active_scene(Scenes::end);
-        return;
-    }
-
-    // Swap between Safehouse and Tower Defence using Shift
-    if (keyPressedOnce(sf::Keyboard::LShift) || keyPressedOnce(sf::Keyboard::RShift)) {
-        GameSystem::set_active_scene(Scenes::tower_defence);
-        return;
-    }
 }
 
 
+void SafehouseScene::publish(FrameSnapshot& out) const {
+    out.background = sf::Color(30, 15, 15);
+    Scene::publish(out); // player
 
-void SafehouseScene::render(sf::RenderWindow& window) {
-    window.draw(_background);
-    Scene::render(window); // player
-
+    // Moving shapes are drawn between their last two sim positions
     for (const auto& inv : _invaders) {
-        window.draw(inv.shape);
+        out.add_circle(inv.prevPos, inv.shape.getPosition(),
+            inv.shape.getRadius(), inv.shape.getFillColor());
     }
 
     for (const auto& b : _enemyBullets) {
-        window.draw(b.shape);
+        out.add_bullet(b.prevPos, b.shape.getPosition(),
+            b.shape.getRadius(), b.shape.getFillColor());
     }
 
     if (_attackEffectTimer > 0.f) {
-        window.draw(_attackArcShape);
+        out.add_triangle(_attackArc[0], _attackArc[1], _attackArc[2],
+            sf::Color(255, 255, 255, 60));
     }
 
-    window.draw(_label);
-    window.draw(_hpText);   // show HP of player 
-    window.draw(_waveText);
+    out.add_text("SAFEHOUSE", { 20.f, 20.f }, 32);
+    out.add_text(_hpText, { 20.f, 60.f });   // show HP of player
+    out.add_text(_waveText, { 20.f, 90.f }); // just below HP text
 }
 
 // ============================================================================
 // TowerDefenceScene
 // ============================================================================
-void TowerDefenceScene::load() {
-    _background.setSize({
-        static_cast<float>(param::game_width),
-        static_cast<float>(param::game_height)
-        });
-    _background.setFillColor(sf::Color(5, 5, 20));
+// Slow part of the first load: read + parse the level file and build the
+// enemy path. Only touches the staging members, so it can run on the
+// session's loader thread while the Safehouse ticks us in the background.
+void TowerDefenceScene::prepare() {
+    TRACE_SCOPE("TD::prepare");
+    const float tileSize = 50.f;
 
-    if (!_font.loadFromFile("res/fonts/ARIAL.TTF")) {
-        std::cerr << "Failed to load font: res/fonts/ARIAL.TTF\n";
+    // Configure level tile colours for TD
+    _stagedLevel.set_color(ls::EMPTY, sf::Color(10, 10, 30));
+    _stagedLevel.set_color(ls::WALL, sf::Color(60, 60, 80));
+    _stagedLevel.set_color(ls::WAYPOINT, sf::Color(120, 120, 120));
+    _stagedLevel.set_color(ls::START, sf::Color(80, 255, 80));
+    _stagedLevel.set_color(ls::END, sf::Color(255, 80, 80));
+
+    // Load the TD level: the copy the build compiled if there is one and
+    // it's up to date (just mapped in), else parse the text file
+    const std::uint64_t source = LevelSystem::source_hash(param::td_1);
+    if (!_stagedLevel.load_compiled(LevelSystem::compiled_path(param::td_1), source, tileSize)) {
+        _stagedLevel.load_level(param::td_1, tileSize);
     }
 
-    _label.setFont(_font);
-    _label.setString("TOWER DEFENCE");
-    _label.setCharacterSize(32);
-    _label.setFillColor(sf::Color::White);
-    _label.setPosition(20.f, 20.f);
+    // Build the path (+ tiles) enemies will follow
+    build_enemy_path(_stagedLevel, _stagedPath);
+}
 
-    // Wave UI text
-    _waveText.setFont(_font);
-    _waveText.setCharacterSize(24);
-    _waveText.setFillColor(sf::Color::White);
-    _waveText.setPosition(20.f, 60.f);
-    _waveText.setString("Wave 0/0");
+void TowerDefenceScene::load() {
+    // HUD placeholder until the first update fills it in
+    _waveText = "Wave 0/0";
 
-    const float tileSize = 50.f;
+    LevelSystem& level = _session.level();
 
-    // Configure level tile colours for TD
     if (!_initialised) {
-        ls::set_color(ls::EMPTY, sf::Color(10, 10, 30));
-        ls::set_color(ls::WALL, sf::Color(60, 60, 80));
-        ls::set_color(ls::WAYPOINT, sf::Color(120, 120, 120));
-        ls::set_color(ls::START, sf::Color(80, 255, 80));
-        ls::set_color(ls::END, sf::Color(255, 80, 80));
-
-		// Load the TD level file
-        ls::load_level(param::td_1, tileSize);
+        // Normally already done on the loader thread; a direct load()
+        // (e.g. the headless runner) does it here instead
+        ensure_prepared();
 
         _turrets.clear();
         _enemies.clear();
         _bullets.clear();
-        _enemyPath.clear();
         _escapedEnemyTypes.clear();
 
-        // Build the path (+ tiles) enemies will follow
-        build_enemy_path();
+        // Room for a normal run's waves, so steps don't grow them
+        _enemies.reserve(kReserveEnemies);
+        _enemySteps.reserve(kReserveEnemies);
+        _bullets.reserve(kReserveBullets);
+        _turretShots.reserve(kReserveTurrets);
+        _escapedEnemyTypes.reserve(kEscapeQueueSize);
+
+        // Take over the prepared level and path
+        level.swap(_stagedLevel);
+        _enemyPath.swap(_stagedPath);
+        _stagedPath.clear();
 
         // Reset wave manager at the start of a new run / level
+        _waveManager.setSeed(_session.get_seed());
         _waveManager.reset();
 
         // Create the shared player for TD mode
         _entities.clear();
-        _player = std::make_shared<Player>();
-        _player->set_use_tile_collision(true);
-        _player->set_position({ 150.f, 100.f });
+        _player = std::make_shared<Player>(_session.input());
+        _player->set_tile_collision(&level);
+        _player->teleport({ 150.f, 100.f });
         _entities.push_back(_player);
 
         _initialised = true;
@@ -635,6 +668,8 @@ void TowerDefenceScene::load() {
     }
 }
 void TowerDefenceScene::tick_simulation(float dt) {
+    TRACE_SCOPE("TD::tick_simulation");
+    ALLOC_SCOPE(Sim);
     if (_enemyPath.empty()) return;
 
     // 1) WaveManager handles spawning when an active wave is running
@@ -650,128 +685,157 @@ void TowerDefenceScene::tick_simulation(float dt) {
     );
 
     // 2) Normal TD simulation
-    update_enemies(dt);
-    update_turrets(dt);
+    JobSystem* jobs = _session.get_job_system();
+    if (jobs && _enemyPath.size() >= 2 && _enemies.size() >= kParallelMinEnemies) {
+        // Same phases as below, with path advance and target acquisition
+        // split into chunks across the job system's workers:
+        //   advance (parallel) -> collect -> acquire (parallel) -> fire
+        using clock = std::chrono::steady_clock;
+        const clock::time_point start = clock::now();
+        clock::time_point enemiesDone = start;
+
+        _enemySteps.resize(_enemies.size());
+        _turretShots.resize(_turrets.size());
+
+        auto advance = jobs->parallel_for(_enemies.size(), kEnemyGrain,
+            [this, dt](size_t begin, size_t end) {
+                TRACE_SCOPE("TD::advance_enemies");
+                ALLOC_SCOPE(TdEnemies);
+                advance_enemies(begin, end, dt);
+            });
+        auto collect = jobs->submit([this, &enemiesDone] {
+            TRACE_SCOPE("TD::collect_enemies");
+            ALLOC_SCOPE(TdEnemies);
+            collect_enemies();
+            enemiesDone = clock::now();
+            }, { advance });
+        auto acquire = jobs->parallel_for(_turrets.size(), kTurretGrain,
+            [this, dt](size_t begin, size_t end) {
+                TRACE_SCOPE("TD::acquire_targets");
+                ALLOC_SCOPE(TdTurrets);
+                acquire_targets(begin, end, dt);
+            },
+            { collect });
+        jobs->wait(acquire);
+
+        TRACE_SCOPE("TD::fire_turrets");
+        ALLOC_SCOPE(TdTurrets);
+        fire_turrets();
+
+        // Phase times as seen by this thread: enemies end when the collect
+        // job does, turrets take the rest
+        const std::chrono::duration<float, std::milli> enemiesMs = enemiesDone - start;
+        const std::chrono::duration<float, std::milli> turretsMs = clock::now() - enemiesDone;
+        _session.get_stats().add(Stat::UpdateEnemies, enemiesMs.count());
+        _session.get_stats().add(Stat::UpdateTurrets, turretsMs.count());
+    }
+    else {
+        update_enemies(dt);
+        update_turrets(dt);
+    }
     update_bullets(dt);
 }
 
 
 
 // Build list of world-space positions enemies move through (from + tiles)
-void TowerDefenceScene::build_enemy_path() {
-    _enemyPath.clear();
+void TowerDefenceScene::build_enemy_path(const LevelSystem& level,
+    std::vector<sf::Vector2f>& path)
+{
+    TRACE_SCOPE("TD::build_enemy_path");
+    path.clear();
 
-    const int w = ls::get_width();
-    const int h = ls::get_height();
     const float tileSize = 50.f;
 
-    std::vector<sf::Vector2i> waypoints;
-    waypoints.reserve(w * h);
-
-    // Collect all WAYPOINT tiles from the level
-    for (int y = 0; y < h; ++y) {
-        for (int x = 0; x < w; ++x) {
-            sf::Vector2i grid(x, y);
-            if (ls::get_tile(grid) == ls::WAYPOINT) {
-                waypoints.push_back(grid);
-            }
-        }
-    }
-
-    if (waypoints.empty()) {
+    // The level orders the WAYPOINT chain when it loads (or the compiled
+    // level already has it)
+    const std::vector<sf::Vector2i>& ordered = level.get_path();
+    if (ordered.empty()) {
         std::cerr << "No WAYPOINT tiles found for enemy path.\n";
         return;
     }
 
-    // Pick the "start" waypoint: smallest x, then smallest y
-    sf::Vector2i start = waypoints[0];
-    for (const auto& p : waypoints) {
-        if (p.x < start.x || (p.x == start.x && p.y < start.y)) {
-            start = p;
-        }
-    }
-
-    auto index = [w](sf::Vector2i p) {
-        return p.y * w + p.x;
-        };
-
-    std::vector<bool> visited(static_cast<size_t>(w * h), false);
-    std::vector<sf::Vector2i> ordered;
-    ordered.reserve(waypoints.size());
-
-    sf::Vector2i current = start;
-    ordered.push_back(current);
-    visited[static_cast<size_t>(index(current))] = true;
-
-    // 4-connected neighbor directions
-    const sf::Vector2i dirs[4] = {
-        { 1,  0 },
-        { -1, 0 },
-        { 0,  1 },
-        { 0, -1 }
-    };
-
-    // Walk the connected chain of WAYPOINT tiles
-    bool extended = true;
-    while (extended) {
-        extended = false;
-
-        for (const auto& d : dirs) {
-            sf::Vector2i next = current + d;
-            if (next.x < 0 || next.y < 0 || next.x >= w || next.y >= h) {
-                continue;
-            }
-
-            if (ls::get_tile(next) == ls::WAYPOINT &&
-                !visited[static_cast<size_t>(index(next))]) {
-
-                ordered.push_back(next);
-                visited[static_cast<size_t>(index(next))] = true;
-                current = next;
-                extended = true;
-                break;
-            }
-        }
-    }
-
     // Convert grid coords to world positions (center of each tile)
-    _enemyPath.reserve(ordered.size());
+    path.reserve(ordered.size());
     for (const auto& grid : ordered) {
-        sf::Vector2f tilePos = ls::get_tile_position(grid);
-        _enemyPath.push_back(tilePos + sf::Vector2f(tileSize * 0.5f, tileSize * 0.5f));
+        sf::Vector2f tilePos = level.get_tile_position(grid);
+        path.push_back(tilePos + sf::Vector2f(tileSize * 0.5f, tileSize * 0.5f));
     }
 
-    std::cout << "Enemy path built with " << _enemyPath.size() << " nodes.\n";
+    std::cout << "Enemy path built with " << path.size() << " nodes.\n";
 }
 
 
 void TowerDefenceScene::update_enemies(float dt) {
+    TRACE_SCOPE("TD::update_enemies");
+    ALLOC_SCOPE(TdEnemies);
+    ScopedStatTimer timer(_session.get_stats(), Stat::UpdateEnemies);
     if (_enemyPath.size() < 2) return;
 
+    _enemySteps.resize(_enemies.size());
+    advance_enemies(0, _enemies.size(), dt);
+    collect_enemies();
+}
+
+
+// Move enemies [begin, end) along the path. Each enemy only touches itself
+// and its own _enemySteps slot, so ranges can run on different threads.
+void TowerDefenceScene::advance_enemies(size_t begin, size_t end, float dt) {
     const float tileSize = 50.f;
+    const bool  flash = FrameGovernor::hit_flash(_session.get_quality());
 
-    std::vector<TDEnemy> alive;
-    alive.reserve(_enemies.size());
+    for (size_t i = begin; i < end; ++i) {
+        TDEnemy& enemy = _enemies[i];
 
-    for (auto& enemy : _enemies) {
         // Skip enemies that have already been killed by turrets/bullets
         if (enemy.isDead()) {
+            _enemySteps[i] = EnemyStep::Dead;
             continue;
         }
 
         // Let TDEnemy handle movement + flashing
-        bool reachedEnd = enemy.update(dt, _enemyPath, tileSize);
+        const bool reachedEnd = enemy.update(dt, _enemyPath, tileSize, flash);
+        _enemySteps[i] = reachedEnd ? EnemyStep::Escaped : EnemyStep::Alive;
+    }
+}
+
 
-        if (reachedEnd) {
+// Drop dead and escaped enemies (in order); escapes wait for the flush
+void TowerDefenceScene::collect_enemies() {
+    size_t kept = 0;
+    for (size_t i = 0; i < _enemies.size(); ++i) {
+        switch (_enemySteps[i]) {
+        case EnemyStep::Escaped:
             // Tell the Safehouse what type escaped
-            _escapedEnemyTypes.push_back(static_cast<int>(enemy.getType()));
-        }
-        else {
-            alive.push_back(enemy);
+            _escapedEnemyTypes.push_back(static_cast<int>(_enemies[i].getType()));
+            ++_escapedTotal;
+            break;
+
+        case EnemyStep::Alive:
+            if (kept != i) _enemies[kept] = std::move(_enemies[i]);
+            ++kept;
+            break;
+
+        case EnemyStep::Dead:
+            break;
         }
     }
+    _enemies.erase(_enemies.begin() + static_cast<std::ptrdiff_t>(kept), _enemies.end());
+}
 
-    _enemies.swap(alive);
+
+// Move pending escaped types onto the escape queue, oldest first.
+// Whatever doesn't fit stays pending until the next tick.
+void TowerDefenceScene::flush_escaped_enemies() {
+    if (_escapedEnemyTypes.empty()) return;
+
+    size_t pushed = 0;
+    while (pushed < _escapedEnemyTypes.size() &&
+        _escapeQueue.push(_escapedEnemyTypes[pushed])) {
+        ++pushed;
+    }
+    _escapedEnemyTypes.erase(_escapedEnemyTypes.begin(),
+        _escapedEnemyTypes.begin() + static_cast<std::ptrdiff_t>(pushed));
 }
 
 
@@ -786,46 +850,118 @@ void TowerDefenceScene::place_turret() {
         static_cast<int>(pos.y / tileSize)
     );
 
-    LevelSystem::Tile tile;
-    try {
-        tile = ls::get_tile(grid);
-    }
-    catch (...) {
-        return;
-    }
+    place_turret_at(grid);
+}
 
-    // Only allow placing on EMPTY tiles
-    if (tile != ls::EMPTY) {
-        return;
-    }
 
-    // Don’t double-place a turret on the same tile
-    for (const auto& t : _turrets) {
-        if (t.getGrid() == grid) {
-            return;
-        }
+// Place a turret on a specific grid tile. Returns false if the tile is
+// out of range, not EMPTY, or already has a turret.
+bool TowerDefenceScene::place_turret_at(const sf::Vector2i& grid) {
+    const float tileSize = 50.f;
+    LevelSystem& level = _session.level();
+
+    // Only allow placing on free buildable (EMPTY) tiles on the level
+    if (!level.in_range(grid) ||
+        (level.get_flags(grid) & (ls::BUILDABLE | ls::OCCUPIED)) != ls::BUILDABLE) {
+        return false;
     }
 
     // World position of this tile
-    sf::Vector2f worldPos = ls::get_tile_position(grid);
+    sf::Vector2f worldPos = level.get_tile_position(grid);
 
-    // Create a new turret instance
+    // Create a new turret instance, and claim the tile
     _turrets.emplace_back(grid, worldPos, tileSize);
+    level.set_occupied(grid, true);
+    return true;
+}
+
+
+void TowerDefenceScene::count_live(size_t& entities, size_t& bullets) const {
+    entities += _entities.size() + _enemies.size() + _turrets.size() + _bullets.size();
+    bullets += _bullets.size();
+}
+
+void TowerDefenceScene::hash_state(StateHash& h) const {
+    Scene::hash_state(h);
+    _waveManager.hashState(h);
+
+    h.add(static_cast<std::uint64_t>(_enemies.size()));
+    for (const auto& e : _enemies) e.hash_state(h);
+    h.add(static_cast<std::uint64_t>(_turrets.size()));
+    for (const auto& t : _turrets) t.hash_state(h);
+    h.add(static_cast<std::uint64_t>(_bullets.size()));
+    for (const auto& b : _bullets) b.hash_state(h);
+
+    h.add(static_cast<std::uint64_t>(_escapedTotal));
+}
+
+void TowerDefenceScene::report_memory(MemoryReport& out) const {
+    out.add_vector(MemPool::Enemies, _enemies);
+    for (const auto& e : _enemies) out.add(MemPool::Enemies, MemSize::shape(e.getShape()));
+    out.add_buffer(MemPool::Enemies, _enemySteps);
+
+    out.add_vector(MemPool::Bullets, _bullets);
+    for (const auto& b : _bullets) out.add(MemPool::Bullets, MemSize::shape(b.getShape()));
+
+    out.add_vector(MemPool::Turrets, _turrets);
+    for (const auto& t : _turrets) out.add(MemPool::Turrets, MemSize::shape(t.getShape()));
+    out.add_buffer(MemPool::Turrets, _turretShots);
+
+    // Escaped enemies waiting for room in the queue count as the enemies
+    // they were; the queue itself is a fixed ring inside the scene
+    out.add_buffer(MemPool::Enemies, _escapedEnemyTypes);
+
+    out.add_buffer(MemPool::LevelTiles, _enemyPath);
+
+    // The staged level is only ours to read once prepare() has finished
+    if (is_prepared()) {
+        _stagedLevel.report_memory(out);
+        out.add_buffer(MemPool::LevelTiles, _stagedPath);
+    }
+
+    out.add(MemPool::HudText, MemSize::string(_waveText));
+}
+
+
+void TowerDefenceScene::start_next_wave() {
+    if (_waveManager.isWaitingForPlayer()) {
+        _waveManager.startNextWave();
+    }
 }
 
 
 // Ask each turret if it wants to fire this frame and spawn bullets
 void TowerDefenceScene::update_turrets(float dt) {
+    TRACE_SCOPE("TD::update_turrets");
+    ALLOC_SCOPE(TdTurrets);
+    ScopedStatTimer timer(_session.get_stats(), Stat::UpdateTurrets);
     if (_turrets.empty()) return;
 
-    for (auto& t : _turrets) {
-        sf::Vector2f bulletPos;
-        sf::Vector2f bulletDir;
+    _turretShots.resize(_turrets.size());
+    acquire_targets(0, _turrets.size(), dt);
+    fire_turrets();
+}
+
+
+// Cooldown + target selection for turrets [begin, end). Enemies are only
+// read, and each turret writes its own _turretShots slot.
+void TowerDefenceScene::acquire_targets(size_t begin, size_t end, float dt) {
+    for (size_t i = begin; i < end; ++i) {
+        TurretShot& shot = _turretShots[i];
 
         // TDTurret handles range, cooldown, target selection.
         // If it returns true, we spawn a bullet.
-        if (t.update(dt, _enemies, bulletPos, bulletDir)) {
-            _bullets.emplace_back(bulletPos, bulletDir);
+        shot.fired = _turrets[i].update(dt, _enemies, shot.pos, shot.dir);
+    }
+}
+
+
+// Spawn this tick's bullets in turret order
+void TowerDefenceScene::fire_turrets() {
+    for (size_t i = 0; i < _turrets.size(); ++i) {
+        const TurretShot& shot = _turretShots[i];
+        if (shot.fired) {
+            _bullets.emplace_back(shot.pos, shot.dir);
         }
     }
 
@@ -842,19 +978,22 @@ void TowerDefenceScene::update_turrets(float dt) {
 
 // Move bullets, apply damage, and cull dead bullets + enemies
 void TowerDefenceScene::update_bullets(float dt) {
+    TRACE_SCOPE("TD::update_bullets");
+    ALLOC_SCOPE(TdBullets);
+    ScopedStatTimer timer(_session.get_stats(), Stat::UpdateBullets);
     if (_bullets.empty()) return;
 
-    std::vector<TDBullet> alive;
-    alive.reserve(_bullets.size());
-
-    for (auto& b : _bullets) {
+    // Survivors are packed to the front in order, in place
+    size_t kept = 0;
+    for (size_t i = 0; i < _bullets.size(); ++i) {
         // TDBullet::update handles movement + collision + enemy damage.
-        if (b.update(dt, _enemies)) {
-            alive.push_back(b);   // still alive this frame
+        if (_bullets[i].update(dt, _enemies)) {
+            if (kept != i) _bullets[kept] = std::move(_bullets[i]);
+            ++kept;   // still alive this frame
         }
         // else: bullet expired or hit something -> drop it
     }
-    _bullets.swap(alive);
+    _bullets.erase(_bullets.begin() + static_cast<std::ptrdiff_t>(kept), _bullets.end());
 
     // Clean out enemies that died from bullet damage
     _enemies.erase(
@@ -867,87 +1006,119 @@ void TowerDefenceScene::update_bullets(float dt) {
 }
 
 
-// Return and clear list of types of enemies that reached the end of the path
-std::vector<int> TowerDefenceScene::consume_escaped_enemies() {
-    // SafehouseScene calls this each frame to request "who escaped this tick".
-    // We return the current list and then clear it so we don't respawn the same
-    // enemies again on the next frame.
-    auto result = _escapedEnemyTypes;
-    _escapedEnemyTypes.clear();
-    return result;
+// Append the types of enemies that reached the end of the path since the
+// last call. SafehouseScene drains this every tick (consumer side).
+void TowerDefenceScene::drain_escaped_enemies(std::vector<int>& out) {
+    int type = 0;
+    while (_escapeQueue.pop(type)) {
+        out.push_back(type);
+    }
 }
 
 void TowerDefenceScene::update(const float& dt) {
+    // Run safehouse simulation in the background too, on the sim worker
+    // thread in parallel with our own update + tick below, at a reduced
+    // rate unless something is happening there
+    SimWorker& backgroundSim = _session.background_sim();
+    SimLod&    backgroundLod = _session.background_lod();
+    auto* sh = static_cast<SafehouseScene*>(_session.safehouse.get());
+    float bgDt = 0.f;
+    const int bgTicks = sh ? backgroundLod.schedule(sh, dt, bgDt) : 0;
+    if (bgTicks > 0) {
+        backgroundSim.run([sh, bgTicks, bgDt] {
+            for (int i = 0; i < bgTicks; ++i) sh->tick_simulation(bgDt);
+            });
+    }
+
     // Update the player in this scene
     Scene::update(dt);
 
-    // Run safehouse simulation in the background too
-    if (Scenes::safehouse) {
-        auto sh = std::static_pointer_cast<SafehouseScene>(Scenes::safehouse);
-        sh->tick_simulation(dt);
-    }
+    // Run full TD sim (spawning, movement, turrets, bullets)
+    tick_simulation(dt);
 
-    // Handle starting the next wave with E
-    if (_waveManager.isWaitingForPlayer() && keyPressedOnce(sf::Keyboard::E)) {
-        _waveManager.startNextWave();
+    backgroundSim.wait();
+    flush_escaped_enemies();
+
+    // Player took damage or new invaders arrived: back to full rate
+    if (sh) {
+        const int    health = sh->get_player_health();
+        const size_t invaders = sh->get_invader_count();
+        if (health != _seenPlayerHealth || invaders > _seenInvaders) {
+            backgroundLod.wake();
+        }
+        _seenPlayerHealth = health;
+        _seenInvaders = invaders;
     }
 
-    // Swap back to Safehouse with Shift (LShift or RShift)
-    if (keyPressedOnce(sf::Keyboard::LShift) || keyPressedOnce(sf::Keyboard::RShift)) {
-        GameSystem::set_active_scene(Scenes::safehouse);
+    // Player died in the Safehouse while we were away
+    if (sh && sh->is_player_dead()) {
+        _session.set_active_scene(_session.end);
         return;
     }
 
-    // Place a turret on the player's current tile with F
-    if (keyPressedOnce(sf::Keyboard::F)) {
-        place_turret();
+    // --- Update wave UI text (less often under load) ---
+    if (!FrameGovernor::refresh_hud(_session.get_quality(), _session.get_tick())) {
+        return;
     }
-
-    // Run full TD sim (spawning, movement, turrets, bullets)
-    tick_simulation(dt);
-
-    // --- Update wave UI text ---
     if (!_waveManager.hasFinishedAllWaves()) {
         int levelIdx = _waveManager.getCurrentLevelIndex() + 1;
         int waveIdx = _waveManager.getCurrentWaveIndex() + 1;
         int totalWaves = _waveManager.getWavesInCurrentLevel();
 
-        std::string extra;
-        if (_waveManager.isWaitingForPlayer()) {
-            extra = "  (Press E to start)";
-        }
-
-        _waveText.setString(
-            "Level " + std::to_string(levelIdx) +
-            " - Wave " + std::to_string(waveIdx) +
-            "/" + std::to_string(totalWaves) +
-            extra
-        );
+        format_wave_text(_waveText, levelIdx, waveIdx, totalWaves,
+            _waveManager.isWaitingForPlayer() ? "  (Press E to start)" : "");
     }
     else {
-        _waveText.setString("All waves complete");
+        _waveText.assign("All waves complete");
     }
 }
 
 
-void TowerDefenceScene::render(sf::RenderWindow& window) {
-    // Background colour for TD scene
-    window.draw(_background);
+void TowerDefenceScene::handle_command(const SimCommand& cmd) {
+    switch (cmd.type) {
+    case SimCommandType::StartWave:
+        // Handle starting the next wave with E
+        start_next_wave();
+        break;
 
-    // Draw the tile grid (walls, path, etc.)
-    ls::render(window);
+    case SimCommandType::PlaceTurret:
+        // Place a turret on the player's current tile with F
+        place_turret();
+        break;
 
-    // Draw the player (from Scene base class)
-    Scene::render(window);
+    case SimCommandType::SwapScene:
+        // Swap back to Safehouse with Shift (LShift or RShift)
+        _session.request_scene(_session.safehouse);
+        break;
 
-    // Draw turrets, bullets, and enemies
-    for (const auto& turret : _turrets) turret.render(window);
-    for (const auto& b : _bullets)      b.render(window);
-    for (const auto& enemy : _enemies)  window.draw(enemy.getShape());
+    default:
+        break;
+    }
+}
+
+
+void TowerDefenceScene::publish(FrameSnapshot& out) const {
+    // Background colour for TD scene, then the tile grid (walls, path, etc.)
+    out.background = sf::Color(5, 5, 20);
+    out.level = &_session.level();
+
+    // Camera follows the player (only moves on levels bigger than the window)
+    if (_player) {
+        out.follow_camera(_player->get_previous_position(), _player->get_position(),
+            _session.level().get_world_size());
+    }
+
+    // Player (from Scene base class)
+    Scene::publish(out);
+
+    // Turrets, bullets, and enemies
+    for (const auto& turret : _turrets) turret.publish(out);
+    for (const auto& b : _bullets)      b.publish(out);
+    for (const auto& enemy : _enemies)  enemy.publish(out);
 
     // Scene label at top-left
-    window.draw(_label);
-    window.draw(_waveText);
+    out.add_text("TOWER DEFENCE", { 20.f, 20.f }, 32);
+    out.add_text(_waveText, { 20.f, 60.f });
 }
 
 // ============================================================================
@@ -955,36 +1126,24 @@ void TowerDefenceScene::render(sf::RenderWindow& window) {
 // ============================================================================
 
 void EndScene::load() {
-    // Load font and configure "Game Over" text
-    if (_font.loadFromFile("res/fonts/arial.ttf")) {
-        _win_text.setFont(_font);
-        _win_text.setString("GAME OVER\nPress R to restart");
-        _win_text.setCharacterSize(36);
-        _win_text.setFillColor(sf::Color::White);
-
-        // Roughly centred (hard-coded for now)
-        _win_text.setPosition(200.f, 200.f);
-    }
+    // Nothing to set up; the text is added in publish()
 }
 
 void EndScene::update(const float& dt) {
-    // No entities to update, so just handle input
+    // No entities to update; input arrives through handle_command()
     (void)dt; // silence unused warning if any
+}
 
+void EndScene::handle_command(const SimCommand& cmd) {
     // Press R to restart a fresh run
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::R)) {
-        // Recreate the core scenes from scratch.
-        // we go straight back to Safehouse + TowerDefence.
-        Scenes::safehouse = std::make_shared<SafehouseScene>();
-        Scenes::tower_defence = std::make_shared<TowerDefenceScene>();
-
-        // Jump back to the start of the run (Safehouse)
-        GameSystem::set_active_scene(Scenes::safehouse);
+    if (cmd.type == SimCommandType::Restart) {
+        // Recreate the core scenes from scratch and go straight back to
+        // the Safehouse
+        _session.restart();
     }
 }
 
-void EndScene::render(sf::RenderWindow& window) {
-    // Only draw if we have text set up
-    if (_win_text.getString().isEmpty()) return;
-    window.draw(_win_text);
+void EndScene::publish(FrameSnapshot& out) const {
+    // "Game Over" text, roughly centred (hard-coded for now)
+    out.add_text("GAME OVER\nPress R to restart", { 200.f, 200.f }, 36);
 }
@@ -6,6 +6,7 @@
 #include <SFML/Graphics.hpp>
 
 #include "game_systems.hpp"
+#include "game_session.hpp"
 #include "run_context.hpp"
 #include "EnemyType.hpp"
 #include "TDEnemy.hpp"
@@ -14,6 +15,7 @@
 #include "WaveGeneration.hpp"
 #include "TDEnemy.hpp"
 #include "EnemyType.hpp"
+#include "spsc_queue.hpp"
 
 class Player;
 
@@ -22,14 +24,11 @@ class Player;
 // ---------------------------------
 class EndScene : public Scene {
 public:
-    EndScene() = default;
+    explicit EndScene(GameSession& session) : Scene(session) {}
     void load() override;
     void update(const float& dt) override;
-    void render(sf::RenderWindow& window) override;
-
-private:
-    sf::Text _win_text;   // "Game Over" text
-    sf::Font _font;       // font used for the end screen
+    void publish(FrameSnapshot& out) const override;
+    void handle_command(const SimCommand& cmd) override;
 };
 
 
@@ -38,21 +37,35 @@ private:
 // ---------------------------------
 class SafehouseScene : public Scene {
 public:
-    SafehouseScene() = default;
+    explicit SafehouseScene(GameSession& session) : Scene(session) {}
 
     void load() override;
     void update(const float& dt) override;
-    void render(sf::RenderWindow& window) override;
-
-    // Called from TowerDefenceScene so Safehouse can keep simulating
+    void publish(FrameSnapshot& out) const override;
+    void handle_command(const SimCommand& cmd) override;
+    void count_live(size_t& entities, size_t& bullets) const override;
+    void hash_state(StateHash& h) const override;
+    void report_memory(MemoryReport& out) const override;
+
+    // Called from TowerDefenceScene so Safehouse can keep simulating.
+    // Safe to run on a worker thread in parallel with the TD tick: it only
+    // touches Safehouse state plus the consumer end of TD's escape queue,
+    // and never switches scenes itself (callers check is_player_dead()).
     void tick_simulation(float dt);
 
     // Called when enemies escape from TD
     void spawn_invaders(const std::vector<int>& enemyTypes);
 
+    // Read-only state for tools (headless runner, debug UI)
+    bool   is_player_dead()        const;
+    int    get_player_health()     const;
+    size_t get_invader_count()     const { return _invaders.size(); }
+    size_t get_enemy_bullet_count() const { return _enemyBullets.size(); }
+
 private:
     struct Invader {
         sf::CircleShape shape;
+        sf::Vector2f prevPos;      // position at start of last step (render lerp)
         float speed = 0.f;
         int   hp = 1;
         int   maxHp = 1;
@@ -71,6 +84,7 @@ private:
 
     struct EnemyBullet {
         sf::CircleShape shape;
+        sf::Vector2f    prevPos;   // position at start of last step (render lerp)
         sf::Vector2f    vel;
         float           speed = 220.f;
         float           ttl = 3.f;
@@ -79,12 +93,10 @@ private:
 
     bool _initialised = false;
 
-    sf::RectangleShape _background;
-    sf::Font           _font;
-    sf::Text           _label;
-    sf::Text           _hpText;
-    sf::Text           _waveText;
-    sf::ConvexShape    _attackArcShape;
+    // HUD strings (drawn by the renderer from the snapshot)
+    std::string  _hpText;
+    std::string  _waveText;
+    sf::Vector2f _attackArc[3];   // melee arc triangle, world space
 
     std::shared_ptr<Player> _player;
 
@@ -95,6 +107,18 @@ private:
     float _attackEffectTimer = 0.f;
     float _damageCooldown = 0.f;
 
+    // Reused buffer for enemy types pulled off TD's escape queue
+    std::vector<int> _escapedBuffer;
+
+    // Last TD escape count seen, to wake the background TD sim on escapes
+    long _seenEscapes = 0;
+
+    // Starting capacity of the per-step containers (they still grow past it)
+    static constexpr size_t kReserveInvaders = 256;
+    static constexpr size_t kReserveEnemyBullets = 512;
+
+    void pull_escaped_enemies();
+    void melee_attack(const sf::Vector2f& aim);
     void update_invaders(float dt);
     void update_enemy_bullets(float dt);
 };
@@ -105,17 +129,49 @@ private:
 // ---------------------------------
 class TowerDefenceScene : public Scene {
 public:
-    TowerDefenceScene() = default;
+    explicit TowerDefenceScene(GameSession& session) : Scene(session) {}
 
     void load() override;
     void update(const float& dt) override;
-    void render(sf::RenderWindow& window) override;
-
-    // Run TD simulation (spawning, movement, turrets, bullets)
+    void publish(FrameSnapshot& out) const override;
+    void handle_command(const SimCommand& cmd) override;
+    void count_live(size_t& entities, size_t& bullets) const override;
+    void hash_state(StateHash& h) const override;
+    void report_memory(MemoryReport& out) const override;
+
+    // Run TD simulation (spawning, movement, turrets, bullets).
+    // Producer end of the escape queue; safe to run in parallel with
+    // SafehouseScene::tick_simulation.
     void tick_simulation(float dt);
 
-    // Safehouse asks which enemies escaped this tick
-    std::vector<int> consume_escaped_enemies();
+    // Producer end: hand this step's escaped enemies to the Safehouse.
+    // Called once both sims are done with the step, so the Safehouse always
+    // sees them on its next tick whichever thread ran what (replays depend
+    // on that).
+    void flush_escaped_enemies();
+
+    // Consumer end: append enemy types that have escaped since the last call.
+    // Only one thread may drain at a time (the Safehouse sim).
+    void drain_escaped_enemies(std::vector<int>& out);
+
+    // Player actions, also callable directly by scripted/headless runs
+    void start_next_wave();
+    bool place_turret_at(const sf::Vector2i& grid);
+
+    // Live entity counts (for tools / debug output)
+    size_t get_enemy_count()  const { return _enemies.size(); }
+    size_t get_turret_count() const { return _turrets.size(); }
+    size_t get_bullet_count() const { return _bullets.size(); }
+
+    // Total enemies that have reached the end of the path this run
+    long get_escaped_total() const { return _escapedTotal; }
+
+    // Capacity of the escape queue to the Safehouse
+    static constexpr size_t kEscapeQueueSize = 256;
+
+    // World-space path (tile centres) enemies follow through a TD level,
+    // start to end. Also used by tools that drive TD entities directly.
+    static void build_enemy_path(const LevelSystem& level, std::vector<sf::Vector2f>& path);
 
     // Wave UI helpers (used by SafehouseScene to show current wave)
     bool hasFinishedAllWaves()    const { return _waveManager.hasFinishedAllWaves(); }
@@ -123,12 +179,11 @@ public:
     int  getCurrentLevelIndex()   const { return _waveManager.getCurrentLevelIndex(); }
     int  getCurrentWaveIndex()    const { return _waveManager.getCurrentWaveIndex(); }
     int  getWavesInCurrentLevel() const { return _waveManager.getWavesInCurrentLevel(); }
+    int  getRemainingPoints()     const { return _waveManager.getRemainingPoints(); }
 
 private:
-    sf::RectangleShape _background;
-    sf::Font           _font;
-    sf::Text           _label;
-    sf::Text           _waveText;
+    // HUD string (drawn by the renderer from the snapshot)
+    std::string _waveText;
 
     std::shared_ptr<Player> _player;
 
@@ -137,28 +192,57 @@ private:
     std::vector<TDBullet> _bullets;
 
     std::vector<sf::Vector2f> _enemyPath;
-    std::vector<int>          _escapedEnemyTypes;
+
+    // Level + path loaded by prepare() (possibly on the loader thread),
+    // taken over by the first load()
+    LevelSystem               _stagedLevel;
+    std::vector<sf::Vector2f> _stagedPath;
+
+    // Per-item results of the phases that can run as parallel jobs,
+    // reused every tick. Written by index, then applied in order.
+    enum class EnemyStep : unsigned char { Alive, Escaped, Dead };
+    struct TurretShot {
+        bool         fired = false;
+        sf::Vector2f pos;
+        sf::Vector2f dir;
+    };
+    std::vector<EnemyStep>  _enemySteps;
+    std::vector<TurretShot> _turretShots;
+
+    // Below this many enemies the job overhead isn't worth it
+    static constexpr size_t kParallelMinEnemies = 512;
+    static constexpr size_t kEnemyGrain = 256;    // enemies per job
+    static constexpr size_t kTurretGrain = 2;     // turrets per job (each scans every enemy)
+
+    // Starting capacity of the per-step containers, enough for a normal
+    // run's waves without growing mid-wave (they still grow past it)
+    static constexpr size_t kReserveEnemies = 256;
+    static constexpr size_t kReserveBullets = 512;
+    static constexpr size_t kReserveTurrets = 64;
+
+    // Escaped enemy types cross over to the Safehouse through a lock-free
+    // ring; anything that doesn't fit waits in _escapedEnemyTypes (producer
+    // side only) and is retried next tick, so nothing is dropped.
+    SpscQueue<int, kEscapeQueueSize> _escapeQueue;
+    std::vector<int>                 _escapedEnemyTypes;
+    long                             _escapedTotal = 0;
+
+    // Last Safehouse state seen, to wake the background sim on damage/arrivals
+    int    _seenPlayerHealth = -1;
+    size_t _seenInvaders = 0;
 
     bool _initialised = false;
 
     WaveManager _waveManager;
 
-    void build_enemy_path();
+    void prepare() override;
     void update_enemies(float dt);
+    void advance_enemies(size_t begin, size_t end, float dt);
+    void collect_enemies();
     void update_turrets(float dt);
+    void acquire_targets(size_t begin, size_t end, float dt);
+    void fire_turrets();
     void update_bullets(float dt);
     void place_turret();
 };
 
-
-// ---------------------------------
-// Global scene handles (shared everywhere)
-// ---------------------------------
-struct Scenes {
-    static std::shared_ptr<Scene> safehouse;
-    static std::shared_ptr<Scene> tower_defence;
-    static std::shared_ptr<Scene> end;
-
-    // Shared run data (wave number, currency, player stats, etc.)
-    static std::shared_ptr<RunContext> runContext;
-};
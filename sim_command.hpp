@@ -0,0 +1,32 @@
+// sim_command.hpp
+#pragma once
+// Player commands sent from the input/render thread to the sim thread.
+
+#include <SFML/System/Vector2.hpp>
+
+#include <chrono>
+
+#include "input.hpp"
+
+// Append only: replay files store these as ints
+enum class SimCommandType {
+    SwapScene,       // Shift: flip between Safehouse and Tower Defence
+    StartWave,       // E: start the next TD wave
+    PlaceTurret,     // F: place a turret on the TD player's tile
+    MeleeAttack,     // Space: Safehouse melee arc towards `aim`
+    SpawnTestEnemy,  // 1-9: debug spawn of invader type `value`
+    Restart,         // R: start a fresh run from the end screen
+    InputState,      // held keys / mouse changed (handled by GameSystem)
+    SetQuality       // frame governor level `value` (see frame_governor.hpp)
+};
+
+struct SimCommand {
+    SimCommandType type = SimCommandType::SwapScene;
+    sf::Vector2f   aim;        // world-space mouse position (MeleeAttack)
+    int            value = 0;  // EnemyType as int (SpawnTestEnemy), level (SetQuality)
+    InputFrame     input;      // InputState only
+
+    // When the input edge behind this command was polled, for the latency
+    // stats. Not part of replays; default (epoch) = not measured.
+    std::chrono::steady_clock::time_point issued;
+};
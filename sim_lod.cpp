@@ -0,0 +1,54 @@
+// sim_lod.cpp
+#include "sim_lod.hpp"
+#include "game_parameters.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using param = Parameters;
+
+int SimLod::schedule(const void* target, float dt, float& tickDt) {
+    if (_divisor == 0) _divisor = param::background_tick_divisor;
+
+    // Different hidden scene than last time: start fresh
+    if (target != _target) {
+        _target = target;
+        _pending = 0.f;
+        _steps = 0;
+    }
+
+    _pending += dt;
+    ++_steps;
+
+    if (_wakeTimer > 0.f) {
+        _wakeTimer = std::max(_wakeTimer - dt, 0.f);
+    }
+
+    const int every = (is_full_rate() ? 1 : _divisor) * _slowdown;
+    if (_steps < every) {
+        return 0; // not this step
+    }
+
+    // Catch up on everything we skipped, in ticks no bigger than the max dt
+    // (longer when slowed down, or catching up would cost the same again)
+    const float maxDt = param::background_max_dt * static_cast<float>(_slowdown);
+    const int ticks = std::max(1,
+        static_cast<int>(std::ceil(_pending / maxDt - 1e-4f)));
+    tickDt = _pending / static_cast<float>(ticks);
+
+    _pending = 0.f;
+    _steps = 0;
+    return ticks;
+}
+
+void SimLod::wake() {
+    _wakeTimer = param::background_wake_time;
+}
+
+void SimLod::set_divisor(int divisor) {
+    _divisor = std::max(divisor, 1);
+}
+
+void SimLod::set_slowdown(int factor) {
+    _slowdown = std::max(factor, 1);
+}
@@ -0,0 +1,42 @@
+// sim_lod.hpp
+#pragma once
+
+// Simulation level-of-detail for the off-screen scene.
+//
+// The visible scene steps every fixed step; the hidden one only needs to
+// stay roughly in sync, so it ticks once every `divisor` steps with the
+// time it missed. That time is split into ticks no longer than
+// Parameters::background_max_dt so bullets and spawn timers stay stable.
+// Interesting events (an escape, player damage) call wake(), which puts
+// the hidden scene back on full rate for a while.
+class SimLod {
+public:
+    // Called once per visible-scene step with that step's dt.
+    // Returns how many ticks of `tickDt` the hidden scene should run now
+    // (0 = skip this step). `target` identifies the hidden scene; when it
+    // changes (scene swap) any pending time is dropped.
+    int schedule(const void* target, float dt, float& tickDt);
+
+    // Run the hidden scene at full rate for Parameters::background_wake_time
+    void wake();
+
+    // 1 = always full rate, 2 = every other step, ...
+    void set_divisor(int divisor);
+    int  get_divisor() const { return _divisor; }
+
+    // True while woken (or when the divisor is 1)
+    bool is_full_rate() const { return _divisor <= 1 || _wakeTimer > 0.f; }
+
+    // Under load (FrameGovernor): tick `factor` times less often, woken or
+    // not, with ticks up to `factor` times longer. 1 = normal.
+    void set_slowdown(int factor);
+    int  get_slowdown() const { return _slowdown; }
+
+private:
+    const void* _target = nullptr;
+    float       _pending = 0.f;     // sim time the hidden scene hasn't run yet
+    int         _steps = 0;         // visible steps since the last hidden tick
+    float       _wakeTimer = 0.f;   // seconds of full rate left
+    int         _divisor = 0;       // 0 = use Parameters default
+    int         _slowdown = 1;
+};
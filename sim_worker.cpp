@@ -0,0 +1,55 @@
+// sim_worker.cpp
+#include "sim_worker.hpp"
+#include "trace.hpp"
+
+SimWorker::~SimWorker() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _cv.notify_all();
+    if (_thread.joinable()) _thread.join();
+}
+
+void SimWorker::run(std::function<void()> job) {
+    wait();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_thread.joinable()) {
+            _thread = std::thread(&SimWorker::loop, this);
+        }
+        _job = std::move(job);
+        _frame = Trace::get_frame();
+        _busy = true;
+    }
+    _cv.notify_all();
+}
+
+void SimWorker::wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return !_busy; });
+}
+
+void SimWorker::loop() {
+    Trace::set_thread_name("sim worker");
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+        _cv.wait(lock, [this] { return _busy || _quit; });
+        if (_busy) {
+            // Run the job without holding the lock so wait() callers can block
+            Trace::set_frame(_frame);
+            lock.unlock();
+            _job();
+            lock.lock();
+
+            _job = nullptr;
+            _busy = false;
+            _cv.notify_all();
+        }
+        else if (_quit) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,41 @@
+// sim_worker.hpp
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// One persistent background thread that runs a single job at a time.
+// Used to tick the off-screen scene's simulation in parallel with the
+// visible one:
+//   worker.run([&]{ other->tick_simulation(dt); });
+//   ... this scene's own update ...
+//   worker.wait();
+class SimWorker {
+public:
+    SimWorker() = default;
+    ~SimWorker();
+
+    SimWorker(const SimWorker&) = delete;
+    SimWorker& operator=(const SimWorker&) = delete;
+
+    // Hand a job to the worker and return immediately.
+    // Any previous job is waited on first.
+    void run(std::function<void()> job);
+
+    // Block until the current job (if any) has finished
+    void wait();
+
+private:
+    void loop();
+
+    std::thread             _thread;   // started lazily on first run()
+    std::mutex              _mutex;
+    std::condition_variable _cv;
+    std::function<void()>   _job;
+    std::uint64_t           _frame = 0;   // caller's trace frame
+    bool                    _busy = false;
+    bool                    _quit = false;
+};
@@ -0,0 +1,61 @@
+// spsc_queue.hpp
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer / single-consumer ring buffer.
+//  - Exactly one thread may push and exactly one thread may pop at a time
+//  - No locks and no allocation after construction
+//  - Capacity must be a power of two (one slot is always kept free)
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+        "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false (and leaves the queue untouched) when full.
+    bool push(const T& value) {
+        const std::size_t head = _head.load(std::memory_order_relaxed);
+        const std::size_t next = (head + 1) & kMask;
+        if (next == _tail.load(std::memory_order_acquire)) {
+            return false; // full
+        }
+        _slots[head] = value;
+        _head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when there is nothing to read.
+    bool pop(T& out) {
+        const std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false; // empty
+        }
+        out = _slots[tail];
+        _tail.store((tail + 1) & kMask, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is active
+    bool empty() const {
+        return _tail.load(std::memory_order_acquire) ==
+            _head.load(std::memory_order_acquire);
+    }
+
+    static constexpr std::size_t capacity() { return Capacity - 1; }
+
+private:
+    static constexpr std::size_t kMask = Capacity - 1;
+
+    // Head and tail live on separate cache lines so the two threads
+    // don't keep stealing the same line from each other
+    alignas(64) std::atomic<std::size_t> _head{ 0 }; // next slot to write
+    alignas(64) std::atomic<std::size_t> _tail{ 0 }; // next slot to read
+    alignas(64) std::array<T, Capacity>  _slots{};
+};
@@ -0,0 +1,54 @@
+// state_hash.hpp
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <SFML/System/Vector2.hpp>
+
+// Cheap 64-bit hash (FNV-1a) over simulation state, for checking that two
+// builds step bit-for-bit the same (tile_engine_headless --hash-check).
+//  - Floats are hashed by their bits, so any change in rounding shows up
+//  - Integers other than int are widened to 64 bits, so a count (size_t,
+//    uint32_t, ...) hashes the same whatever its type is on the platform
+//  - Feed values in a fixed order; the order is part of the hash
+class StateHash {
+public:
+    static constexpr std::uint64_t kOffset = 14695981039346656037ull;
+    static constexpr std::uint64_t kPrime = 1099511628211ull;
+
+    StateHash() = default;
+    explicit StateHash(std::uint64_t seed) : _value(seed) {}
+
+    void add_bytes(const void* data, std::size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            _value = (_value ^ bytes[i]) * kPrime;
+        }
+    }
+
+    void add(std::uint64_t v) { add_bytes(&v, sizeof(v)); }
+    void add(int v)           { add_bytes(&v, sizeof(v)); }
+    void add(bool v)          { add(v ? 1 : 0); }
+    void add(float v) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        add_bytes(&bits, sizeof(bits));
+    }
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    void add(T v) { add(static_cast<std::uint64_t>(v)); }
+    void add(const sf::Vector2f& v) { add(v.x); add(v.y); }
+    void add(const sf::Vector2i& v) { add(v.x); add(v.y); }
+
+    std::uint64_t value() const { return _value; }
+
+    // Chain one tick's hash onto a running hash over a whole run
+    static std::uint64_t combine(std::uint64_t rolling, std::uint64_t tick) {
+        StateHash h(rolling);
+        h.add(tick);
+        return h.value();
+    }
+
+private:
+    std::uint64_t _value = kOffset;
+};
@@ -1,4 +1,6 @@
 #include "td_bullet.hpp"
+#include "frame_snapshot.hpp"
+#include "state_hash.hpp"
 #include <cmath>
 
 TDBullet::TDBullet(const sf::Vector2f& startPos,
@@ -7,6 +9,7 @@ TDBullet::TDBullet(const sf::Vector2f& startPos,
     int   damage,
     float ttl)
     : _pos(startPos),
+    _prevPos(startPos),
     _vel(direction),
     _speed(speed),
     _damage(damage),
@@ -27,6 +30,7 @@ bool TDBullet::update(float dt, std::vector<TDEnemy>& enemies) {
     }
 
     // Move forwards
+    _prevPos = _pos;
     _pos += _vel * _speed * dt;
     _shape.setPosition(_pos);
 
@@ -52,3 +56,13 @@ bool TDBullet::update(float dt, std::vector<TDEnemy>& enemies) {
     // Still flying
     return true;
 }
+
+void TDBullet::publish(FrameSnapshot& out) const {
+    out.add_bullet(_prevPos, _pos, _shape.getRadius(), _shape.getFillColor());
+}
+
+void TDBullet::hash_state(StateHash& h) const {
+    h.add(_pos);
+    h.add(_vel);
+    h.add(_ttl);
+}
@@ -4,6 +4,9 @@
 #include <vector>
 #include "TDEnemy.hpp"
 
+struct FrameSnapshot;
+class StateHash;
+
 // Simple tower-defence bullet: flies in a straight line, damages the
 // first enemy it hits, or disappears when its lifetime runs out.
 class TDBullet {
@@ -19,13 +22,17 @@ public:
     // false if it should be removed.
     bool update(float dt, std::vector<TDEnemy>& enemies);
 
-    // Drawing helper
-    void render(sf::RenderWindow& window) const { window.draw(_shape); }
+    // Add to the frame snapshot (interpolated from the last step's start)
+    void publish(FrameSnapshot& out) const;
+
+    // Feed position, velocity and lifetime into a state checksum
+    void hash_state(StateHash& h) const;
 
     const sf::CircleShape& getShape() const { return _shape; }
 
 private:
     sf::Vector2f   _pos;
+    sf::Vector2f   _prevPos;  // position at start of last update
     sf::Vector2f   _vel;      // assumed normalised
     float          _speed;
     int            _damage;
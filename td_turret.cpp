@@ -1,5 +1,7 @@
 #include "td_turret.hpp"
 #include "TDEnemy.hpp"
+#include "frame_snapshot.hpp"
+#include "state_hash.hpp"
 
 #include <cmath>
 
@@ -16,7 +18,7 @@ TDTurret::TDTurret(const sf::Vector2i& grid,
 
 // Decide if this turret fires a bullet this frame
 bool TDTurret::update(float dt,
-    std::vector<TDEnemy>& enemies,
+    const std::vector<TDEnemy>& enemies,
     sf::Vector2f& outBulletPos,
     sf::Vector2f& outBulletDir)
 {
@@ -34,7 +36,7 @@ bool TDTurret::update(float dt,
         _shape.getPosition() + 0.5f * _shape.getSize();
 
     // Find closest enemy in range
-    TDEnemy* best = nullptr;
+    const TDEnemy* best = nullptr;
     float bestDistSq = rangeSq;
 
     for (auto& e : enemies) {
@@ -73,6 +75,11 @@ bool TDTurret::update(float dt,
     return true;
 }
 
-void TDTurret::render(sf::RenderWindow& window) const {
-    window.draw(_shape);
+void TDTurret::publish(FrameSnapshot& out) const {
+    out.add_rect(_shape.getPosition(), _shape.getSize(), _shape.getFillColor());
+}
+
+void TDTurret::hash_state(StateHash& h) const {
+    h.add(_grid);
+    h.add(_cooldown);
 }
@@ -4,6 +4,8 @@
 #include <vector>
 
 class TDEnemy;
+struct FrameSnapshot;
+class StateHash;
 
 // Turret that lives on the TD grid and shoots at enemies
 class TDTurret {
@@ -13,13 +15,17 @@ public:
 
     // Update cooldown and target enemies.
     // If it fires this frame, returns true and fills outBulletPos / outBulletDir.
+    // Only reads the enemies, so turrets can be updated in parallel.
     bool update(float dt,
-        std::vector<TDEnemy>& enemies,
+        const std::vector<TDEnemy>& enemies,
         sf::Vector2f& outBulletPos,
         sf::Vector2f& outBulletDir);
 
-    // Draw turret
-    void render(sf::RenderWindow& window) const;
+    // Add turret to the frame snapshot
+    void publish(FrameSnapshot& out) const;
+
+    // Feed grid position and cooldown into a state checksum
+    void hash_state(StateHash& h) const;
 
     const sf::Vector2i& getGrid() const { return _grid; }
     const sf::RectangleShape& getShape() const { return _shape; }
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+// Compiled level format (.lvl). tile_level_compiler writes one for each
+// res/levels/*.txt at build time; LevelSystem::load_compiled() maps it and
+// uses the cells in place, so loading is mostly paging the file in.
+//
+//   LevelFileHeader
+//   cells      (width + 2) * (height + 2) bytes: LevelSystem's padded grid,
+//              tile type + flag bits per byte
+//   padding    to a 4-byte boundary
+//   positions  typeCounts[t] LevelFilePoints for each Tile t, in Tile order
+//   path       pathCount LevelFilePoints: the enemy path, start to end
+//
+// Native byte order. A file with the wrong magic or version, a source
+// hash that doesn't match the current text level (stale), sides over
+// kMaxSide, a point off the level, or a payload hash that doesn't match
+// is rejected and the text level is loaded instead.
+struct LevelFilePoint {
+    std::int32_t x;
+    std::int32_t y;
+};
+
+struct LevelFileHeader {
+    static constexpr char          kMagic[4] = { 'D', 'L', 'V', 'L' };
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::uint32_t kTileTypes = 6;   // LevelSystem::kTileTypes
+    static constexpr std::uint32_t kMaxSide = 16384; // tiles, either way
+
+    char           magic[4];
+    std::uint32_t  version;
+    std::uint32_t  headerSize;        // sizeof(LevelFileHeader)
+    std::uint32_t  width;
+    std::uint32_t  height;
+    LevelFilePoint start;             // grid; -1,-1 if none
+    LevelFilePoint end;
+    std::uint32_t  typeCounts[kTileTypes];
+    std::uint32_t  pathCount;
+    std::uint64_t  sourceHash;        // FNV-1a of the .txt it was built from
+    std::uint64_t  payloadHash;       // FNV-1a of everything after the header
+};
+static_assert(sizeof(LevelFileHeader) == 80, "LevelFileHeader layout changed: bump kVersion");
@@ -1,110 +1,184 @@
 #include "level_system.hpp"
+#include "../trace.hpp"
+#include "../memory_report.hpp"
+#include "../state_hash.hpp"
+#include "level_file.hpp"
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 
 // -------------------------
-// Static member definitions
+// Construction
 // -------------------------
 
-// Raw tile data for the loaded level, stored in row-major order.
-std::unique_ptr<LevelSystem::Tile[]> LevelSystem::_tiles;
-
-// Level dimensions (in tiles).
-int LevelSystem::_width = 0;
-int LevelSystem::_height = 0;
-
-// World-space offset for the top-left of the level.
-// Lets us move the whole grid around if needed.
-sf::Vector2f LevelSystem::_offset(0.f, 0.f);
-
-// Size of a single tile (width/height in pixels).
-float LevelSystem::_tile_size = 100.f;
-
-// Cached world position of the "start" tile (for spawning the player).
-sf::Vector2f LevelSystem::_start_position(0.f, 0.f);
-
-// One drawable rect per tile, built from the tile data.
-std::vector<std::unique_ptr<sf::RectangleShape>> LevelSystem::_sprites;
-
-// Colour lookup table for each tile type.
-std::map<LevelSystem::Tile, sf::Color> LevelSystem::_colors{
-    { WALL,     sf::Color(200, 200, 200) },
-    { END,      sf::Color(255,  80,  80) },
-    { START,    sf::Color(80, 255,  80) },
-    { EMPTY,    sf::Color(25,  25,  25) },
-    { ENEMY,    sf::Color(255, 180,   0) },
-    { WAYPOINT, sf::Color(80, 160, 255) }
+namespace {
+// Default colour for each tile type, indexed by Tile (scenes can override
+// per level).
+struct TileRgb { std::uint8_t r, g, b; };
+constexpr TileRgb kDefaultColors[LevelSystem::kTileTypes] = {
+    {  25,  25,  25 },   // EMPTY
+    {  80, 255,  80 },   // START
+    { 255,  80,  80 },   // END
+    { 200, 200, 200 },   // WALL
+    { 255, 180,   0 },   // ENEMY
+    {  80, 160, 255 },   // WAYPOINT
 };
+}
+
+LevelSystem::LevelSystem() {
+    for (size_t t = 0; t < kTileTypes; ++t) {
+        _colors[t] = sf::Color(kDefaultColors[t].r, kDefaultColors[t].g, kDefaultColors[t].b);
+    }
+}
 
 // -------------------------
 // Simple getters
 // -------------------------
 
-int LevelSystem::get_height() { return _height; }
-int LevelSystem::get_width() { return _width; }
-sf::Vector2f LevelSystem::get_start_position() { return _start_position; }
+int LevelSystem::get_height() const { return _height; }
+int LevelSystem::get_width() const { return _width; }
+sf::Vector2f LevelSystem::get_start_position() const { return _start_position; }
 
 // Look up the colour for a specific tile type.
-sf::Color LevelSystem::get_color(LevelSystem::Tile t) {
-    auto it = _colors.find(t);
-    if (it == _colors.end()) return sf::Color::Transparent;
-    return it->second;
+sf::Color LevelSystem::get_color(LevelSystem::Tile t) const {
+    if (t >= kTileTypes) return sf::Color::Transparent;
+    return _colors[t];
 }
 
-// Override the colour used when drawing a specific tile type.
+// Override the colour used when drawing a specific tile type, and patch
+// the tiles of that type that are already built.
 void LevelSystem::set_color(LevelSystem::Tile t, sf::Color c) {
+    if (t >= kTileTypes) return;
+    std::lock_guard<std::mutex> lock(_render_mutex);
     _colors[t] = c;
+
+    // Chunks not built yet pick the colour up when they are
+    for (size_t index : _resident) color_chunk(index, t, c);
 }
 
 // Convert from grid coordinates (tile x,y) to world coordinates (pixels).
-sf::Vector2f LevelSystem::get_tile_position(sf::Vector2i p) {
+sf::Vector2f LevelSystem::get_tile_position(sf::Vector2i p) const {
     return _offset + sf::Vector2f(p.x * _tile_size, p.y * _tile_size);
 }
 
 // Get the tile type at a specific grid coordinate.
 // Throws if the coordinates are out of range.
-LevelSystem::Tile LevelSystem::get_tile(sf::Vector2i p) {
-    if (p.x < 0 || p.y < 0 || p.x >= _width || p.y >= _height) {
+LevelSystem::Tile LevelSystem::get_tile(sf::Vector2i p) const {
+    if (!in_range(p)) {
         throw std::string("Tile out of range: ") + std::to_string(p.x) + "," + std::to_string(p.y);
     }
-    return _tiles[(p.y * _width) + p.x];
+    return tile_unchecked(p);
 }
 
 // Get the tile type at a world-space position (pixels).
 // This does a simple floor(v / tile_size) to map back into grid space.
-LevelSystem::Tile LevelSystem::get_tile_at(sf::Vector2f v) {
+LevelSystem::Tile LevelSystem::get_tile_at(sf::Vector2f v) const {
+    const std::optional<Tile> tile = find_tile_at(v);
+    if (!tile) throw std::string("Tile out of range");
+    return *tile;
+}
+
+// Non-throwing versions, for per-frame queries (movement, placement).
+std::optional<LevelSystem::Tile> LevelSystem::find_tile(sf::Vector2i p) const {
+    if (!in_range(p)) return std::nullopt;
+    return tile_unchecked(p);
+}
+
+std::optional<LevelSystem::Tile> LevelSystem::find_tile_at(sf::Vector2f v) const {
+    const std::optional<sf::Vector2i> grid = find_grid_at(v);
+    if (!grid) return std::nullopt;
+    return tile_unchecked(*grid);
+}
+
+std::optional<sf::Vector2i> LevelSystem::find_grid_at(sf::Vector2f v) const {
     const sf::Vector2f a = v - _offset;
-    if (a.x < 0 || a.y < 0) throw std::string("Tile out of range");
-    const sf::Vector2i grid = sf::Vector2i(a / _tile_size);
-    return get_tile(grid);
+    if (a.x < 0 || a.y < 0) return std::nullopt;
+    const sf::Vector2i grid(a / _tile_size);
+    if (!in_range(grid)) return std::nullopt;
+    return grid;
+}
+
+// Locked: render() may be building a chunk from these cells right now
+// (sim-thread reads need no lock, the sim is the only writer).
+void LevelSystem::set_occupied(sf::Vector2i p, bool occupied) {
+    if (!in_range(p)) return;
+    std::lock_guard<std::mutex> lock(_render_mutex);
+    if (occupied) _cells[cell(p)] |= OCCUPIED;
+    else          _cells[cell(p)] &= static_cast<std::uint8_t>(~OCCUPIED);
 }
 
 // -------------------------
-// Sprite building
+// Chunk meshes
 // -------------------------
 
-// Build one rectangle sprite per tile so the level can be drawn quickly.
-void LevelSystem::build_sprites() {
-    _sprites.clear();
-    _sprites.reserve(_width * _height);
-
-    for (int y = 0; y < _height; ++y) {
-        for (int x = 0; x < _width; ++x) {
-            auto rect = std::make_unique<sf::RectangleShape>();
+// Lay out the chunk table for the loaded level. No meshes yet: render()
+// builds each chunk the first time the view reaches it.
+void LevelSystem::init_chunks() {
+    _chunks.clear();
+    _resident.clear();
+    _chunksX = (_width + kChunkTiles - 1) / kChunkTiles;
+    _chunksY = (_height + kChunkTiles - 1) / kChunkTiles;
+    _chunks.resize(static_cast<size_t>(_chunksX) * _chunksY);
+}
 
-            // Position the rect at the correct world-space tile position.
-            rect->setPosition(get_tile_position({ x, y }));
-            rect->setSize({ _tile_size, _tile_size });
+// Tile range [x0, x1) x [y0, y1) covered by one chunk
+void LevelSystem::chunk_tiles(size_t index, int& x0, int& y0, int& x1, int& y1) const {
+    x0 = static_cast<int>(index % _chunksX) * kChunkTiles;
+    y0 = static_cast<int>(index / _chunksX) * kChunkTiles;
+    x1 = std::min(x0 + kChunkTiles, _width);
+    y1 = std::min(y0 + kChunkTiles, _height);
+}
 
-            // Pick colour based on the tile type at this grid position.
-            rect->setFillColor(get_color(get_tile({ x, y })));
+// Bake one chunk into a quad per tile. Positions never change after this;
+// colours are patched in place by set_color().
+void LevelSystem::build_chunk(size_t index) const {
+    int x0, y0, x1, y1;
+    chunk_tiles(index, x0, y0, x1, y1);
+
+    sf::VertexArray& mesh = _chunks[index].mesh;
+    mesh.resize(static_cast<size_t>(x1 - x0) * (y1 - y0) * 4);
+
+    size_t v = 0;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            const sf::Vector2f pos = get_tile_position({ x, y });
+            const sf::Color    c = get_color(tile_unchecked({ x, y }));
+
+            // Corners clockwise from the top-left, like a RectangleShape
+            mesh[v + 0] = sf::Vertex(pos, c);
+            mesh[v + 1] = sf::Vertex({ pos.x + _tile_size, pos.y }, c);
+            mesh[v + 2] = sf::Vertex({ pos.x + _tile_size, pos.y + _tile_size }, c);
+            mesh[v + 3] = sf::Vertex({ pos.x, pos.y + _tile_size }, c);
+            v += 4;
+        }
+    }
+    _chunks[index].resident = true;
+    _resident.push_back(index);
+}
 
-            _sprites.push_back(std::move(rect));
+// Recolour the tiles of type `t` in one built chunk.
+void LevelSystem::color_chunk(size_t index, Tile t, sf::Color c) const {
+    int x0, y0, x1, y1;
+    chunk_tiles(index, x0, y0, x1, y1);
+
+    sf::VertexArray& mesh = _chunks[index].mesh;
+    size_t v = 0;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x, v += 4) {
+            if (tile_unchecked({ x, y }) != t) continue;
+            for (int i = 0; i < 4; ++i) mesh[v + i].color = c;
         }
     }
 }
 
+size_t LevelSystem::get_resident_chunks() const {
+    std::lock_guard<std::mutex> lock(_render_mutex);
+    return _resident.size();
+}
+
 // -------------------------
 // Level loading
 // -------------------------
@@ -115,12 +189,11 @@ void LevelSystem::build_sprites() {
 //   '+' = waypoint, 'n' = enemy lane.
 // Newlines mark the end of a row.
 void LevelSystem::load_level(const std::string& path, float tile_size) {
+    TRACE_SCOPE("LevelSystem::load_level");
+    std::lock_guard<std::mutex> lock(_render_mutex);
+
     _tile_size = tile_size;
-    _width = 0;
-    _height = 0;
-    _start_position = { 0.f, 0.f };
-    _tiles.reset();
-    _sprites.clear();
+    reset_tiles();
 
     // Read whole file into a single string buffer.
     std::string buffer;
@@ -196,25 +269,383 @@ void LevelSystem::load_level(const std::string& path, float tile_size) {
             std::to_string(temp.size()) + " vs " + std::to_string(w * h) + ")";
     }
 
-    // Copy the temporary vector into our contiguous tile array.
-    _tiles = std::make_unique<Tile[]>(w * h);
+    // Copy the temporary vector into our contiguous cell array, inside a
+    // border of flagless walls, with each tile's flags worked out once
+    // here and every position filed under its type.
     _width = w;
     _height = h;
-    std::copy(temp.begin(), temp.end(), &_tiles[0]);
+    _stride = static_cast<size_t>(w) + 2;
+    const size_t cells = _stride * (static_cast<size_t>(h) + 2);
+    _ownedCells = std::make_unique<std::uint8_t[]>(cells);
+    _cells = _ownedCells.get();
+    std::fill(_cells, _cells + cells, static_cast<std::uint8_t>(WALL));
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            const Tile t = temp[static_cast<size_t>(y) * w + x];
+            _cells[cell({ x, y })] = static_cast<std::uint8_t>(t | type_flags(t));
+            if (indexed(t)) _positions[t].push_back({ x, y });
+        }
+    }
 
-    // Build one drawable rect per tile.
-    build_sprites();
+    // Order the enemy path and lay out the (still empty) chunks.
+    build_path();
+    init_chunks();
     std::cout << "Level " << path << " Loaded: " << w << "x" << h << "\n";
 }
 
+void LevelSystem::reset_tiles() {
+    _width = 0;
+    _height = 0;
+    _stride = 0;
+    _start_position = { 0.f, 0.f };
+    _cells = nullptr;
+    _ownedCells.reset();
+    _file.close();
+    for (auto& positions : _positions) positions.clear();
+    _path.clear();
+    _chunks.clear();
+    _resident.clear();
+    _chunksX = 0;
+    _chunksY = 0;
+}
+
+// Order the WAYPOINT tiles into the chain enemies walk: start from the
+// left-most (then top-most) one and keep stepping to an unvisited
+// 4-connected neighbour. The wall border means a neighbour off the edge
+// is never on the path, so no bounds check.
+void LevelSystem::build_path() {
+    _path.clear();
+
+    const std::vector<sf::Vector2i>& waypoints = _positions[WAYPOINT];
+    if (waypoints.empty()) return;
+
+    sf::Vector2i start = waypoints[0];
+    for (const auto& p : waypoints) {
+        if (p.x < start.x || (p.x == start.x && p.y < start.y)) {
+            start = p;
+        }
+    }
+
+    auto index = [this](sf::Vector2i p) {
+        return static_cast<size_t>(p.y) * _width + p.x;
+    };
+
+    std::vector<bool> visited(static_cast<size_t>(_width) * _height, false);
+    _path.reserve(waypoints.size());
+
+    sf::Vector2i current = start;
+    _path.push_back(current);
+    visited[index(current)] = true;
+
+    const sf::Vector2i dirs[4] = {
+        { 1,  0 },
+        { -1, 0 },
+        { 0,  1 },
+        { 0, -1 }
+    };
+
+    bool extended = true;
+    while (extended) {
+        extended = false;
+
+        for (const auto& d : dirs) {
+            const sf::Vector2i next = current + d;
+            if (has_flags(next, ENEMY_PATH) && !visited[index(next)]) {
+                _path.push_back(next);
+                visited[index(next)] = true;
+                current = next;
+                extended = true;
+                break;
+            }
+        }
+    }
+}
+
+// -------------------------
+// Compiled levels
+// -------------------------
+
+namespace {
+// Padding after the cells so the point arrays are 4-byte aligned
+size_t align4(size_t n) { return (n + 3) & ~static_cast<size_t>(3); }
+
+std::uint64_t hash_bytes(const std::uint8_t* data, size_t size) {
+    StateHash h;
+    h.add_bytes(data, size);
+    return h.value();
+}
+}
+
+std::string LevelSystem::compiled_path(const std::string& text_path) {
+    const size_t dot = text_path.find_last_of('.');
+    const size_t slash = text_path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return text_path + ".lvl";
+    }
+    return text_path.substr(0, dot) + ".lvl";
+}
+
+std::uint64_t LevelSystem::source_hash(const std::string& text_path) {
+    std::ifstream f(text_path, std::ios::binary);
+    if (!f.good()) throw std::string("Couldn't open level file: ") + text_path;
+    const std::vector<char> source((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    StateHash hash;
+    hash.add_bytes(source.data(), source.size());
+    return hash.value();
+}
+
+// Write the loaded level in the compiled format (see level_file.hpp).
+void LevelSystem::save_compiled(const std::string& path, std::uint64_t source_hash) const {
+    std::lock_guard<std::mutex> lock(_render_mutex);
+    if (!_cells) throw std::string("No level loaded to compile: ") + path;
+
+    LevelFileHeader header{};
+    std::memcpy(header.magic, LevelFileHeader::kMagic, sizeof(header.magic));
+    header.version = LevelFileHeader::kVersion;
+    header.headerSize = sizeof(LevelFileHeader);
+    if (_width > static_cast<int>(LevelFileHeader::kMaxSide) || _height > static_cast<int>(LevelFileHeader::kMaxSide)) {
+        throw std::string("Level too large to compile: ") + path;
+    }
+    header.width = static_cast<std::uint32_t>(_width);
+    header.height = static_cast<std::uint32_t>(_height);
+
+    // Same start the text loader caches (the last 's'), and the first 'e'
+    header.start = { -1, -1 };
+    header.end = { -1, -1 };
+    if (!_positions[START].empty()) header.start = { _positions[START].back().x, _positions[START].back().y };
+    if (!_positions[END].empty()) header.end = { _positions[END].front().x, _positions[END].front().y };
+
+    static_assert(LevelFileHeader::kTileTypes == kTileTypes, "level_file.hpp is out of step with Tile");
+    for (size_t t = 0; t < kTileTypes; ++t) {
+        header.typeCounts[t] = static_cast<std::uint32_t>(_positions[t].size());
+    }
+    header.pathCount = static_cast<std::uint32_t>(_path.size());
+    header.sourceHash = source_hash;
+
+    // Payload: cells, padding, then every point list
+    const size_t cells = _stride * (static_cast<size_t>(_height) + 2);
+    std::vector<std::uint8_t> payload(align4(cells), 0);
+    std::memcpy(payload.data(), _cells, cells);
+    auto put = [&payload](const std::vector<sf::Vector2i>& points) {
+        for (const auto& p : points) {
+            const LevelFilePoint point{ p.x, p.y };
+            const auto* bytes = reinterpret_cast<const std::uint8_t*>(&point);
+            payload.insert(payload.end(), bytes, bytes + sizeof(point));
+        }
+    };
+    for (const auto& positions : _positions) put(positions);
+    put(_path);
+
+    // Occupied marks are run state, not level data
+    for (size_t i = 0; i < cells; ++i) payload[i] &= static_cast<std::uint8_t>(~OCCUPIED);
+
+    header.payloadHash = hash_bytes(payload.data(), payload.size());
+
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f.good()) throw std::string("Couldn't write compiled level: ") + path;
+    f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    f.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+    if (!f.good()) throw std::string("Couldn't write compiled level: ") + path;
+}
+
+// Map a compiled level and point the tile grid straight at its cells. The
+// mapping is copy-on-write, so OCCUPIED marks stay in this process.
+bool LevelSystem::load_compiled(const std::string& path, std::uint64_t source_hash, float tile_size) {
+    TRACE_SCOPE("LevelSystem::load_compiled");
+
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    // Everything is checked before touching the current level
+    const std::uint8_t* data = file.data();
+    LevelFileHeader header;
+    if (file.size() < sizeof(header)) {
+        std::cout << "Compiled level " << path << " is truncated, ignoring it\n";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, LevelFileHeader::kMagic, sizeof(header.magic)) != 0 ||
+        header.version != LevelFileHeader::kVersion ||
+        header.headerSize != sizeof(LevelFileHeader)) {
+        std::cout << "Compiled level " << path << " is from another format version, ignoring it\n";
+        return false;
+    }
+    if (header.sourceHash != source_hash) {
+        std::cout << "Compiled level " << path << " is older than its text level, ignoring it\n";
+        return false;
+    }
+
+    auto damaged = [&path]() {
+        std::cout << "Compiled level " << path << " is damaged, ignoring it\n";
+        return false;
+    };
+
+    // Bound every count before the size arithmetic so it can't wrap: no
+    // list can hold more points than the level has tiles
+    if (header.width == 0 || header.height == 0 ||
+        header.width > LevelFileHeader::kMaxSide || header.height > LevelFileHeader::kMaxSide) {
+        return damaged();
+    }
+    const std::uint64_t tiles = std::uint64_t{ header.width } * header.height;
+    std::uint64_t points = header.pathCount;
+    if (header.pathCount > tiles) return damaged();
+    for (std::uint32_t count : header.typeCounts) {
+        if (count > tiles) return damaged();
+        points += count;
+    }
+    const size_t stride = static_cast<size_t>(header.width) + 2;
+    const size_t cells = stride * (static_cast<size_t>(header.height) + 2);
+    const std::uint64_t payloadSize = align4(cells) + points * sizeof(LevelFilePoint);
+    if (file.size() != sizeof(header) + payloadSize ||
+        hash_bytes(data + sizeof(header), static_cast<size_t>(payloadSize)) != header.payloadHash) {
+        return damaged();
+    }
+
+    // Every point has to be on the level: they're used as unchecked grid
+    // coordinates later. Start and end may be -1,-1 (none).
+    auto on_level = [&header](const LevelFilePoint& p) {
+        return p.x >= 0 && p.y >= 0 &&
+            static_cast<std::uint32_t>(p.x) < header.width && static_cast<std::uint32_t>(p.y) < header.height;
+    };
+    auto none = [](const LevelFilePoint& p) { return p.x == -1 && p.y == -1; };
+    if ((!none(header.start) && !on_level(header.start)) || (!none(header.end) && !on_level(header.end))) {
+        return damaged();
+    }
+
+    // Point lists are small; copy them out of the mapping
+    std::array<std::vector<sf::Vector2i>, kTileTypes> positions;
+    std::vector<sf::Vector2i> pathPoints;
+    const std::uint8_t* next = data + sizeof(header) + align4(cells);
+    auto take = [&next, &on_level](std::vector<sf::Vector2i>& out, std::uint32_t count) {
+        out.resize(count);
+        for (auto& p : out) {
+            LevelFilePoint point;
+            std::memcpy(&point, next, sizeof(point));
+            if (!on_level(point)) return false;
+            p = { point.x, point.y };
+            next += sizeof(point);
+        }
+        return true;
+    };
+    for (size_t t = 0; t < kTileTypes; ++t) {
+        if (!take(positions[t], header.typeCounts[t])) return damaged();
+    }
+    if (!take(pathPoints, header.pathCount)) return damaged();
+
+    std::lock_guard<std::mutex> lock(_render_mutex);
+    _tile_size = tile_size;
+    reset_tiles();
+
+    _width = static_cast<int>(header.width);
+    _height = static_cast<int>(header.height);
+    _stride = stride;
+    _cells = file.data() + sizeof(header);
+    _file = std::move(file);
+    _positions = std::move(positions);
+    _path = std::move(pathPoints);
+
+    if (!none(header.start)) _start_position = get_tile_position({ header.start.x, header.start.y });
+
+    init_chunks();
+    std::cout << "Level " << path << " Mapped: " << _width << "x" << _height << "\n";
+    return true;
+}
+
+// Swap in a level that was loaded elsewhere.
+void LevelSystem::swap(LevelSystem& other) {
+    if (&other == this) return;
+    std::scoped_lock lock(_render_mutex, other._render_mutex);
+
+    std::swap(_cells, other._cells);
+    std::swap(_ownedCells, other._ownedCells);
+    _file.swap(other._file);
+    std::swap(_positions, other._positions);
+    std::swap(_path, other._path);
+    std::swap(_width, other._width);
+    std::swap(_height, other._height);
+    std::swap(_stride, other._stride);
+    std::swap(_offset, other._offset);
+    std::swap(_tile_size, other._tile_size);
+    std::swap(_colors, other._colors);
+    std::swap(_start_position, other._start_position);
+    std::swap(_chunks, other._chunks);
+    std::swap(_resident, other._resident);
+    std::swap(_chunksX, other._chunksX);
+    std::swap(_chunksY, other._chunksY);
+}
+
+// -------------------------
+// Memory report
+// -------------------------
+
+void LevelSystem::report_memory(MemoryReport& out) const {
+    std::lock_guard<std::mutex> lock(_render_mutex);
+
+    // One byte per cell, border included; the colour table lives inline
+    const size_t tiles = static_cast<size_t>(_width) * static_cast<size_t>(_height);
+    const size_t padded = _stride * static_cast<size_t>(_height + 2);
+    out.add(MemPool::LevelTiles, _cells ? padded : 0, tiles);
+
+    // Per-type position index and enemy path
+    for (const auto& positions : _positions) out.add_vector(MemPool::LevelTiles, positions);
+    out.add_vector(MemPool::LevelTiles, _path);
+
+    // Chunk table, plus four vertices per tile of the chunks built now
+    out.add_vector(MemPool::LevelMesh, _chunks);
+    out.add_vector(MemPool::LevelMesh, _resident);
+    for (size_t index : _resident) {
+        const size_t vertices = _chunks[index].mesh.getVertexCount();
+        out.add(MemPool::LevelMesh, vertices * sizeof(sf::Vertex), vertices / 4);
+    }
+}
+
 // -------------------------
 // Rendering
 // -------------------------
 
-// Draw every tile sprite to the window.
-void LevelSystem::render(sf::RenderWindow& window) {
-    const size_t N = static_cast<size_t>(_width) * static_cast<size_t>(_height);
-    for (size_t i = 0; i < N; ++i) {
-        window.draw(*_sprites[i]);
+// Draw the chunks the window's view can see, building any that aren't
+// yet, then drop the meshes of chunks that have fallen out of range.
+size_t LevelSystem::render(sf::RenderTarget& target) const {
+    std::lock_guard<std::mutex> lock(_render_mutex);
+    if (_chunks.empty()) return 0;
+
+    // View rectangle in chunks (may reach past the level on any side)
+    const sf::View&    view = target.getView();
+    const sf::Vector2f half = view.getSize() * 0.5f;
+    const sf::Vector2f lo = view.getCenter() - half - _offset;
+    const sf::Vector2f hi = view.getCenter() + half - _offset;
+    const float chunkSize = _tile_size * kChunkTiles;
+    const int cx0 = static_cast<int>(std::floor(lo.x / chunkSize));
+    const int cy0 = static_cast<int>(std::floor(lo.y / chunkSize));
+    const int cx1 = static_cast<int>(std::floor(hi.x / chunkSize));
+    const int cy1 = static_cast<int>(std::floor(hi.y / chunkSize));
+
+    size_t drawCalls = 0;
+    for (int cy = std::max(cy0, 0); cy <= std::min(cy1, _chunksY - 1); ++cy) {
+        for (int cx = std::max(cx0, 0); cx <= std::min(cx1, _chunksX - 1); ++cx) {
+            const size_t index = static_cast<size_t>(cy) * _chunksX + cx;
+            if (!_chunks[index].resident) build_chunk(index);
+            target.draw(_chunks[index].mesh);
+            ++drawCalls;
+        }
+    }
+
+    // Keep a margin around the view resident so a camera moving back and
+    // forth over a chunk edge doesn't rebuild it every frame
+    for (size_t i = 0; i < _resident.size();) {
+        const size_t index = _resident[i];
+        const int cx = static_cast<int>(index % _chunksX);
+        const int cy = static_cast<int>(index / _chunksX);
+        if (cx < cx0 - kResidentMargin || cx > cx1 + kResidentMargin ||
+            cy < cy0 - kResidentMargin || cy > cy1 + kResidentMargin) {
+            _chunks[index].mesh = sf::VertexArray(sf::Quads);   // frees it
+            _chunks[index].resident = false;
+            _resident[i] = _resident.back();
+            _resident.pop_back();
+        }
+        else {
+            ++i;
+        }
     }
+    return drawCalls;
 }
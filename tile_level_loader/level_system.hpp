@@ -1,56 +1,203 @@
 #pragma once
 #include <SFML/Graphics.hpp>
-#include <map>
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
+#include "mapped_file.hpp"
+
+class MemoryReport;
+
+// One loaded tile level. Each GameSession owns its own, so several runs
+// can load and query levels at the same time without sharing state.
 class LevelSystem {
 public:
     // Types of tiles we support in the level file
-    enum Tile { EMPTY, START, END, WALL, ENEMY, WAYPOINT };
+    enum Tile : std::uint8_t { EMPTY, START, END, WALL, ENEMY, WAYPOINT };
+    static constexpr size_t kTileTypes = WAYPOINT + 1;
+
+    // What a tile is for, stored next to its type so a query is one load
+    // and a mask. Worked out from the type at load, except OCCUPIED, which
+    // whoever builds on a tile sets. The border around the level has none.
+    enum TileFlag : std::uint8_t {
+        WALKABLE   = 1 << 4,   // the player can stand here
+        BUILDABLE  = 1 << 5,   // a turret can go here (unless OCCUPIED)
+        ENEMY_PATH = 1 << 6,   // enemies walk along these
+        OCCUPIED   = 1 << 7,   // a turret stands here
+    };
+
+    // Flags every tile of type `t` starts with
+    static constexpr std::uint8_t type_flags(Tile t) {
+        switch (t) {
+        case EMPTY:    return WALKABLE | BUILDABLE;
+        case START:    return WALKABLE;
+        case END:      return WALKABLE;
+        case WAYPOINT: return ENEMY_PATH;
+        default:       return 0;   // WALL, ENEMY (reserved)
+        }
+    }
+
+    LevelSystem();
+    LevelSystem(const LevelSystem&) = delete;
+    LevelSystem& operator=(const LevelSystem&) = delete;
+
+    // Load a level text file: tiles, type index, enemy path, chunk table
+    void load_level(const std::string& path, float tile_size = 100.f);
+
+    // Compiled levels (see level_file.hpp). load_compiled maps the file and
+    // uses its tiles in place; returns false if it's missing, from another
+    // format version, damaged or not built from `source_hash` (load the
+    // text instead). save_compiled writes the loaded level out, throws if
+    // it can't.
+    bool load_compiled(const std::string& path, std::uint64_t source_hash, float tile_size = 100.f);
+    void save_compiled(const std::string& path, std::uint64_t source_hash) const;
+
+    // Where the build puts the compiled copy of a text level
+    // ("res/levels/td_1.txt" -> "res/levels/td_1.lvl")
+    static std::string compiled_path(const std::string& text_path);
+
+    // Hash of a text level's bytes, as stored in its compiled copy. Throws
+    // if the file can't be read.
+    static std::uint64_t source_hash(const std::string& text_path);
+
+    // Exchange everything (tiles, chunks, colours) with `other`. Cheap, and
+    // safe against render(), so a level can be loaded into a spare
+    // LevelSystem off the sim thread and swapped in when it's needed.
+    void swap(LevelSystem& other);
+
+    // Tiles are drawn in square chunks of kChunkTiles, one mesh (and draw
+    // call) each. A chunk's mesh is built the first time the view reaches
+    // it and dropped once the view is more than kResidentMargin chunks
+    // away, so draw calls and mesh memory depend on the window, not on the
+    // size of the level.
+    static constexpr int kChunkTiles = 32;
+    static constexpr int kResidentMargin = 1;
+
+    // Draw the chunks the target's current view can see (a window, or a
+    // render texture in the bench). Safe to call from the render thread
+    // while the sim thread (re)loads a level, and the only call the render
+    // thread may make (see FrameSnapshot::level). Returns the number of
+    // draw calls.
+    size_t render(sf::RenderTarget& target) const;
 
-    // Load a level text file and build tiles/sprites
-    static void load_level(const std::string& path, float tile_size = 100.f);
+    // Chunks with a built mesh right now
+    size_t get_resident_chunks() const;
 
-    // Draw all level tiles
-    static void render(sf::RenderWindow& window);
+    // Colour helpers for each tile type. set_color recolours the tiles of
+    // that type already in the mesh, in place.
+    sf::Color get_color(Tile t) const;
+    void set_color(Tile t, sf::Color c);
 
-    // Colour helpers for each tile type
-    static sf::Color get_color(Tile t);
-    static void set_color(Tile t, sf::Color c);
+    // Query tile type by grid or world position. Throws if out of range.
+    Tile get_tile(sf::Vector2i grid) const;
+    Tile get_tile_at(sf::Vector2f world) const;
 
-    // Query tile type by grid or world position
-    static Tile get_tile(sf::Vector2i grid);
-    static Tile get_tile_at(sf::Vector2f world);
+    // Same queries without exceptions: empty if out of range
+    std::optional<Tile> find_tile(sf::Vector2i grid) const;
+    std::optional<Tile> find_tile_at(sf::Vector2f world) const;
+
+    // Grid cell under a world position, empty if off the level
+    std::optional<sf::Vector2i> find_grid_at(sf::Vector2f world) const;
+
+    // No range check at all. Valid inside the level and on the WALL
+    // border around it (x in -1..width, y in -1..height), so any
+    // neighbour of a level tile can be looked up directly.
+    Tile tile_unchecked(sf::Vector2i grid) const {
+        return static_cast<Tile>(_cells[cell(grid)] & kTypeMask);
+    }
+    std::uint8_t get_flags(sf::Vector2i grid) const {
+        return static_cast<std::uint8_t>(_cells[cell(grid)] & ~kTypeMask);
+    }
+    // All of `flags` set (same range as tile_unchecked)
+    bool has_flags(sf::Vector2i grid, std::uint8_t flags) const {
+        return (_cells[cell(grid)] & flags) == flags;
+    }
+
+    // Turn OCCUPIED on or off; ignored out of range. Takes the render
+    // lock, as render() reads the same cells.
+    void set_occupied(sf::Vector2i grid, bool occupied);
+
+    bool in_range(sf::Vector2i grid) const {
+        return grid.x >= 0 && grid.y >= 0 && grid.x < _width && grid.y < _height;
+    }
+
+    // Every tile of one type, row by row (top-left first). Only the sparse
+    // types are indexed: EMPTY and WALL, which make up most of a level,
+    // always give an empty list.
+    static constexpr bool indexed(Tile t) { return t != EMPTY && t != WALL; }
+    const std::vector<sf::Vector2i>& get_tiles_of(Tile t) const { return _positions[t]; }
+
+    // The connected chain of WAYPOINT tiles enemies follow, from the
+    // left-most (then top-most) one to the end. Empty if there are none.
+    const std::vector<sf::Vector2i>& get_path() const { return _path; }
 
     // Convert grid coords to world position (top-left of tile)
-    static sf::Vector2f get_tile_position(sf::Vector2i grid);
+    sf::Vector2f get_tile_position(sf::Vector2i grid) const;
 
-    // Level dimensions and start position
-    static int get_height();
-    static int get_width();
-    static sf::Vector2f get_start_position();
+    // Level dimensions (tiles, and pixels) and start position
+    int get_height() const;
+    int get_width() const;
+    sf::Vector2f get_world_size() const { return { _width * _tile_size, _height * _tile_size }; }
+    sf::Vector2f get_start_position() const;
+
+    // Add the tile grid, colour table and tile mesh to a footprint
+    // report (see memory_report.hpp). Safe against load_level() / swap().
+    void report_memory(MemoryReport& out) const;
 
 protected:
-    // Raw tile data (row-major order)
-    static std::unique_ptr<Tile[]> _tiles;
-    static int _width;
-    static int _height;
+    static constexpr std::uint8_t kTypeMask = 0x0f;
+
+    // One byte per tile, row-major: type in the low bits, TileFlag bits
+    // above. Padded with a one-tile WALL border: (width + 2) x (height + 2),
+    // level tile (0,0) at row 1, column 1. Points into _ownedCells (text
+    // levels) or straight into _file (compiled levels).
+    std::uint8_t* _cells = nullptr;
+    std::unique_ptr<std::uint8_t[]> _ownedCells;
+    MappedFile _file;
+    int _width = 0;
+    int _height = 0;
+    size_t _stride = 0;   // width + 2
+
+    size_t cell(sf::Vector2i grid) const {
+        return static_cast<size_t>(grid.y + 1) * _stride + static_cast<size_t>(grid.x + 1);
+    }
+
+    // Per-type positions and the enemy path, built at load
+    std::array<std::vector<sf::Vector2i>, kTileTypes> _positions;
+    std::vector<sf::Vector2i> _path;
+    void build_path();
+
+    // Forget the loaded level (keeps colours and tile size)
+    void reset_tiles();
 
     // Global offset + tile size in pixels
-    static sf::Vector2f _offset;
-    static float _tile_size;
+    sf::Vector2f _offset{ 0.f, 0.f };
+    float _tile_size = 100.f;
 
-    // Per-tile colours and cached start position
-    static std::map<Tile, sf::Color> _colors;
-    static sf::Vector2f _start_position;
+    // Per-tile colours (indexed by Tile) and cached start position
+    std::array<sf::Color, kTileTypes> _colors;
+    sf::Vector2f _start_position{ 0.f, 0.f };
 
-    // One rect per tile for drawing
-    static std::vector<std::unique_ptr<sf::RectangleShape>> _sprites;
-    static void build_sprites();
+    // Chunk table, row-major. A resident chunk's mesh has a quad per tile
+    // (4 vertices, row-major within the chunk); the rest are empty.
+    // Render-side cache, hence mutable (always under _render_mutex).
+    struct Chunk {
+        sf::VertexArray mesh{ sf::Quads };
+        bool            resident = false;
+    };
+    mutable std::vector<Chunk>  _chunks;
+    mutable std::vector<size_t> _resident;   // indices of resident chunks
+    int _chunksX = 0;
+    int _chunksY = 0;
+    void init_chunks();
+    void chunk_tiles(size_t index, int& x0, int& y0, int& x1, int& y1) const;
+    void build_chunk(size_t index) const;
+    void color_chunk(size_t index, Tile t, sf::Color c) const;
 
-private:
-    LevelSystem() = delete;
-    ~LevelSystem() = delete;
+    // Guards _chunks/_colors/_width/_height between load_level() and render()
+    mutable std::mutex _render_mutex;
 };
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A whole file mapped into memory, copy-on-write: reading it only pages
+// the file in, and writes through data() stay private to this process
+// (the file on disk never changes). Move-only; unmaps on destruction.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map `path`. Returns false (and stays closed) if it doesn't exist,
+    // is empty or can't be mapped.
+    bool open(const std::string& path);
+    void close();
+
+    bool          is_open() const { return _data != nullptr; }
+    std::uint8_t* data() const { return _data; }
+    std::size_t   size() const { return _size; }
+
+    void swap(MappedFile& other) noexcept;
+
+private:
+    std::uint8_t* _data = nullptr;
+    std::size_t   _size = 0;
+};
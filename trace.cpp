@@ -0,0 +1,239 @@
+// trace.cpp
+#include "trace.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// -------------------------
+// Per-thread span ring
+// -------------------------
+
+// Single writer (the owning thread), any number of readers. Slot fields are
+// relaxed atomics; `written` is published after each slot is filled, and a
+// reader re-checks it after copying to drop slots that were overwritten
+// while it was reading (seqlock style).
+struct TraceRing {
+    struct Slot {
+        std::atomic<const char*>   name{ nullptr };
+        std::atomic<std::uint64_t> beginNs{ 0 };
+        std::atomic<std::uint64_t> endNs{ 0 };
+        std::atomic<std::uint64_t> frame{ 0 };
+    };
+
+    std::array<Slot, Trace::kRingSize> slots;
+    std::atomic<std::uint64_t>         written{ 0 };
+
+    // Registry mutex only
+    unsigned    tid = 0;
+    std::string threadName;
+    bool        inUse = false;
+};
+
+// Every ring ever handed out. Rings of finished threads keep their spans
+// (a dump still shows that work) until a new thread takes them over.
+struct TraceRegistry {
+    std::mutex                              mutex;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    unsigned                                nextTid = 1;
+};
+
+TraceRegistry& registry() {
+    // Never destroyed: threads may still record while statics go away
+    static TraceRegistry* r = new TraceRegistry();
+    return *r;
+}
+
+std::atomic<bool>          s_enabled{ false };
+const Trace::clock::time_point s_epoch = Trace::clock::now();
+
+// This thread's ring, taken on its first span and given back at thread exit
+struct ThreadTrace {
+    TraceRing*  ring = nullptr;
+    std::string name;
+
+    ~ThreadTrace() {
+        if (!ring) return;
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        ring->inUse = false;
+    }
+
+    TraceRing& acquire() {
+        if (ring) return *ring;
+
+        TraceRegistry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto& r : reg.rings) {
+            if (!r->inUse) {
+                ring = r.get();
+                break;
+            }
+        }
+        if (!ring) {
+            reg.rings.push_back(std::make_unique<TraceRing>());
+            ring = reg.rings.back().get();
+        }
+
+        // Reused rings start over as a new track
+        ring->inUse = true;
+        ring->tid = reg.nextTid++;
+        ring->threadName = name.empty() ? "thread " + std::to_string(ring->tid) : name;
+        ring->written.store(0, std::memory_order_release);
+        return *ring;
+    }
+};
+
+thread_local ThreadTrace t_trace;
+thread_local std::uint64_t t_frame = 0;
+
+std::uint64_t to_ns(Trace::clock::time_point t) {
+    if (t <= s_epoch) return 0;
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t - s_epoch).count());
+}
+
+void write_json_string(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+        else out << c;
+    }
+    out << '"';
+}
+
+// Microseconds with ns precision, as the viewer expects
+void write_us(std::ostream& out, std::uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu.%03u",
+        static_cast<unsigned long long>(ns / 1000), static_cast<unsigned>(ns % 1000));
+    out << buf;
+}
+
+} // namespace
+
+// -------------------------
+// Trace
+// -------------------------
+
+void Trace::set_enabled(bool enabled) {
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Trace::is_enabled() {
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+void Trace::set_frame(std::uint64_t frame) {
+    t_frame = frame;
+}
+
+std::uint64_t Trace::get_frame() {
+    return t_frame;
+}
+
+void Trace::set_thread_name(const std::string& name) {
+    t_trace.name = name;
+    if (t_trace.ring) {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        t_trace.ring->threadName = name;
+    }
+}
+
+void Trace::record(const char* name, clock::time_point begin, clock::time_point end) {
+    TraceRing& ring = t_trace.acquire();
+
+    const std::uint64_t n = ring.written.load(std::memory_order_relaxed);
+    TraceRing::Slot& slot = ring.slots[n % kRingSize];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.beginNs.store(to_ns(begin), std::memory_order_relaxed);
+    slot.endNs.store(to_ns(end), std::memory_order_relaxed);
+    slot.frame.store(t_frame, std::memory_order_relaxed);
+    ring.written.store(n + 1, std::memory_order_release);
+}
+
+bool Trace::write_chrome_json(const std::string& path) {
+    struct Span {
+        const char*   name;
+        std::uint64_t beginNs;
+        std::uint64_t endNs;
+        std::uint64_t frame;
+    };
+
+    std::ofstream out(path);
+    if (!out.good()) {
+        std::cerr << "[Trace] Couldn't open " << path << " for writing\n";
+        return false;
+    }
+
+    std::vector<Span> spans;
+    spans.reserve(kRingSize);
+    size_t total = 0;
+    bool   first = true;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    // Holding the registry lock keeps rings from being handed to new
+    // threads mid-copy; their owners keep recording meanwhile
+    TraceRegistry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto& r : reg.rings) {
+        const TraceRing& ring = *r;
+        const std::uint64_t end = ring.written.load(std::memory_order_acquire);
+        const std::uint64_t begin = (end > kRingSize) ? end - kRingSize : 0;
+
+        spans.clear();
+        for (std::uint64_t n = begin; n < end; ++n) {
+            const TraceRing::Slot& slot = ring.slots[n % kRingSize];
+            spans.push_back({
+                slot.name.load(std::memory_order_relaxed),
+                slot.beginNs.load(std::memory_order_relaxed),
+                slot.endNs.load(std::memory_order_relaxed),
+                slot.frame.load(std::memory_order_relaxed) });
+        }
+
+        // Anything the owner wrapped round onto while we copied is torn
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t after = ring.written.load(std::memory_order_relaxed);
+        const std::uint64_t valid = (after >= kRingSize) ? after - kRingSize + 1 : 0;
+        const size_t skip = (valid > begin) ? static_cast<size_t>(valid - begin) : 0;
+        if (skip >= spans.size()) continue;
+
+        if (!first) out << ",\n";
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring.tid
+            << ",\"args\":{\"name\":";
+        write_json_string(out, ring.threadName);
+        out << "}}";
+
+        for (size_t i = skip; i < spans.size(); ++i) {
+            const Span& s = spans[i];
+            if (!s.name) continue;
+            out << ",\n{\"name\":";
+            write_json_string(out, s.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring.tid << ",\"ts\":";
+            write_us(out, s.beginNs);
+            out << ",\"dur\":";
+            write_us(out, s.endNs >= s.beginNs ? s.endNs - s.beginNs : 0);
+            out << ",\"args\":{\"frame\":" << s.frame << "}}";
+            ++total;
+        }
+    }
+
+    out << "\n]}\n";
+    out.flush();
+    if (!out.good()) {
+        std::cerr << "[Trace] Failed writing " << path << "\n";
+        return false;
+    }
+
+    std::cout << "[Trace] Wrote " << total << " spans to " << path << "\n";
+    return true;
+}
@@ -0,0 +1,69 @@
+// trace.hpp
+#pragma once
+// Scoped trace spans for looking at individual frames in a trace viewer
+// (chrome://tracing or ui.perfetto.dev). FrameStats says a phase is slow
+// on average; a trace says which frame, which phase and which thread.
+//
+// TRACE_SCOPE("name") records one span from there to the end of the block.
+// Each thread writes into its own fixed ring of the newest kRingSize spans,
+// so recording takes no lock and never allocates. write_chrome_json() can
+// be called from any thread at any time and dumps what the rings hold.
+//
+// Span names must be string literals (only the pointer is stored).
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Trace {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t kRingSize = 1 << 14; // spans kept per thread
+
+    // Recording is off until enabled; a disabled TRACE_SCOPE costs one load
+    static void set_enabled(bool enabled);
+    static bool is_enabled();
+
+    // Frame (sim tick) number stamped on spans the calling thread records
+    // from now on. Per thread, so sessions stepping on their own threads
+    // don't mix up each other's numbers; set by whoever drives the frame
+    // loop. JobSystem and SimWorker carry the submitter's frame over to
+    // the thread that runs the job.
+    static void          set_frame(std::uint64_t frame);
+    static std::uint64_t get_frame();
+
+    // Name shown for the calling thread's track in the viewer
+    static void set_thread_name(const std::string& name);
+
+    // Add one finished span to the calling thread's ring
+    static void record(const char* name, clock::time_point begin, clock::time_point end);
+
+    // Write every ring as Chrome trace JSON ("X" events, one track per
+    // thread, frame number in args). Returns false if the file can't be written.
+    static bool write_chrome_json(const std::string& path);
+};
+
+// Records one span from construction to destruction
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : _name(Trace::is_enabled() ? name : nullptr),
+          _begin(_name ? Trace::clock::now() : Trace::clock::time_point{}) {}
+
+    ~TraceScope() {
+        if (_name) Trace::record(_name, _begin, Trace::clock::now());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char*              _name;
+    Trace::clock::time_point _begin;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) const TraceScope TRACE_CONCAT(_traceScope, __LINE__)(name)